@@ -1,160 +1,573 @@
+#include "client_analytics.h"
 #include "event_processor.h"
+#include "event_source.h"
+#include "follow_source.h"
+#include "occupancy_heatmap.h"
+#include "output_encoder.h"
+#include "parallel_parser.h"
+#include "parallel_replay.h"
+#include "sweep.h"
+#include "time_index.h"
+#include "trace.h"
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 namespace {
-std::int32_t parse_time(const std::string& str) {
-  if (str.size() != 5) {
-    return -1;
+const char* event_span_name(pc_club::event_type type) {
+  switch (type) {
+  case pc_club::event_type::enter:
+    return "event:enter";
+  case pc_club::event_type::take:
+    return "event:take";
+  case pc_club::event_type::wait:
+    return "event:wait";
+  case pc_club::event_type::leave:
+    return "event:leave";
+  default:
+    return "event";
   }
-  if (str[2] != ':') {
-    return -1;
-  }
-  std::int32_t time = 0;
-  try {
-    if (std::int32_t h = std::stoi(str.substr(0, 2)); h >= 0 && h <= 23) {
-      time += h * 60;
-    } else {
-      return -1;
-    }
-    if (std::int32_t m = std::stoi(str.substr(3, 2)); m >= 0 && m <= 59) {
-      time += m;
-    } else {
-      return -1;
-    }
-  } catch (...) {
-    return -1;
-  }
-  return time;
 }
 
-bool get_event(const std::string& line, std::int32_t tables, std::vector<std::string> tokens, pc_club::event& e) {
-  if (tokens.size() != 3 && tokens.size() != 4) {
-    return false;
-  }
+struct options {
+  std::vector<const char*> paths;
+  // Analytics mode: report the `top` biggest spenders over all input files instead of the day output.
+  std::size_t top = 0;
+  // Sweep mode: replay the day for every combination of these (the header's value when empty).
+  std::vector<std::int32_t> sweep_tables;
+  std::vector<std::int32_t> sweep_prices;
+  // Write a sidecar index checkpointed every `index_interval` minutes instead of processing.
+  bool build_index = false;
+  std::int32_t index_interval = 60;
+  // Replay: output starts with the first event at this minute; -1 replays the whole day.
+  std::int32_t from = -1;
+  // Per-minute occupancy of the day, written to this file as CSV or binary.
+  const char* heatmap_path = nullptr;
+  bool heatmap_binary = false;
+  const char* trace_path = nullptr;
+  std::uint32_t trace_sample = 1000;
+  // Keep an undo journal so that retraction events (id 5) take back earlier ones.
+  bool corrections = false;
+  bool stream = false;
+  bool follow = false;
+  // Encode a long day's output in segments on all cores; the events are still processed in order.
+  bool parallel = false;
+  pc_club::output_format format = pc_club::output_format::text;
+};
 
-  if (tokens[1].size() != 1 || tokens[1][0] < '1' || tokens[1][0] > '4') {
-    return false;
-  }
-  if (!std::all_of(tokens[2].begin(), tokens[2].end(), [](unsigned char c) {
-        return std::islower(c) || std::isdigit(c) || c == '_';
-      })) {
-    return false;
-  }
-  std::int32_t table = -1;
-  if (tokens.size() == 4) {
-    if (tokens[1][0] != '2') {
+// Comma-separated positive numbers.
+bool parse_list(const char* arg, std::vector<std::int32_t>& values) {
+  std::string_view rest = arg;
+  while (!rest.empty()) {
+    std::string_view item = rest.substr(0, rest.find(','));
+    rest.remove_prefix(std::min(rest.size(), item.size() + 1));
+    std::int32_t value = 0;
+    auto [ptr, ec] = std::from_chars(item.data(), item.data() + item.size(), value);
+    if (ec != std::errc() || ptr != item.data() + item.size() || value <= 0) {
       return false;
     }
-    if (std::all_of(tokens[3].begin(), tokens[3].end(), [](unsigned char c) { return std::isdigit(c); })) {
-      table = std::stoi(tokens[3]);
-      if (table < 1 || table > tables) {
+    values.push_back(value);
+  }
+  return !values.empty();
+}
+
+bool parse_options(int argc, char* argv[], options& opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--trace" && i + 1 < argc) {
+      opts.trace_path = argv[++i];
+    } else if (arg == "--trace-sample" && i + 1 < argc) {
+      opts.trace_sample = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--format" && i + 1 < argc) {
+      if (!pc_club::parse_output_format(argv[++i], opts.format)) {
         return false;
       }
+    } else if (arg == "--top" && i + 1 < argc) {
+      opts.top = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+      if (opts.top == 0) {
+        return false;
+      }
+    } else if (arg == "--sweep-tables" && i + 1 < argc) {
+      if (!parse_list(argv[++i], opts.sweep_tables)) {
+        return false;
+      }
+    } else if (arg == "--sweep-prices" && i + 1 < argc) {
+      if (!parse_list(argv[++i], opts.sweep_prices)) {
+        return false;
+      }
+    } else if (arg == "--build-index") {
+      opts.build_index = true;
+    } else if (arg == "--index-interval" && i + 1 < argc) {
+      opts.index_interval = static_cast<std::int32_t>(std::strtol(argv[++i], nullptr, 10));
+      if (opts.index_interval <= 0) {
+        return false;
+      }
+    } else if (arg == "--from" && i + 1 < argc) {
+      opts.from = pc_club::parse_time(argv[++i]);
+      if (opts.from < 0) {
+        return false;
+      }
+    } else if (arg == "--heatmap" && i + 1 < argc) {
+      opts.heatmap_path = argv[++i];
+    } else if (arg == "--heatmap-format" && i + 1 < argc) {
+      std::string_view name = argv[++i];
+      if (name != "csv" && name != "binary") {
+        return false;
+      }
+      opts.heatmap_binary = name == "binary";
+    } else if (arg == "--corrections") {
+      opts.corrections = true;
+    } else if (arg == "--stream") {
+      opts.stream = true;
+    } else if (arg == "--follow") {
+      opts.follow = opts.stream = true;
+    } else if (arg == "--parallel") {
+      opts.parallel = true;
     } else {
-      return false;
+      opts.paths.push_back(argv[i]);
     }
-  } else if (tokens[1][0] == '2') {
-    return false;
   }
-  e = {
-      .time = parse_time(tokens[0]),
-      .type = static_cast<pc_club::event_type>(tokens[1][0] - '0'),
-      .name = tokens[2],
-      .table = table
-  };
-  if (e.time == -1) {
-    return false;
+  if (!opts.sweep_tables.empty() || !opts.sweep_prices.empty()) {
+    return opts.top == 0 && opts.paths.size() == 1;
   }
-  return true;
+  if (opts.build_index || opts.from >= 0 || opts.follow) {
+    return opts.top == 0 && opts.paths.size() == 1;
+  }
+  // Several files are the days of the analytics mode, or else the terminal logs of one day.
+  return !opts.paths.empty();
 }
 
-bool get_parameters(
-    std::fstream& fin,
-    std::string line,
-    std::int32_t& open,
-    std::int32_t& close,
-    std::int32_t& tables,
-    std::int32_t& price
-) {
-  std::getline(fin, line);
-  try {
-    tables = std::stoi(line);
-  } catch (...) {
-    std::cout << line << '\n';
-    return false;
+// Collects one day's client aggregates into `analytics`; returns the malformed line if there is one.
+std::optional<std::string> analyze_day(const char* path, pc_club::client_analytics& analytics) {
+  std::string input = pc_club::read_file_contents(path);
+  std::string_view section = input;
+  pc_club::club_parameters club{};
+  if (std::string bad_line; !pc_club::read_parameters(section, club, bad_line)) {
+    return bad_line;
   }
-  if (tables <= 0) {
-    std::cout << line << '\n';
-    return false;
+  std::optional<std::string> bad_line;
+  // Days are already spread over the cores, so each one is parsed on the calling thread.
+  auto events = pc_club::parse_events_parallel(section, club.tables, bad_line, {.threads = 1});
+  if (bad_line) {
+    return bad_line;
   }
+  std::ostream discard(nullptr);
+  pc_club::with_event_processor(
+      club.tables,
+      club.price,
+      club.open_time,
+      club.close_time,
+      discard,
+      pc_club::output_format::none,
+      [&](auto& ep) {
+        ep.set_analytics(&analytics);
+        ep.process_events(events);
+        ep.close();
+      }
+  );
+  return std::nullopt;
+}
 
-  std::getline(fin, line);
-  open = parse_time(line.substr(0, 5));
-  close = parse_time(line.substr(6, 5));
+// Analyzes the files on all cores, each worker into its own aggregates, then merges them.
+int run_analytics(const options& opts) {
+  const std::size_t workers = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, opts.paths.size());
+  std::vector<pc_club::client_analytics> partial(workers);
+  std::vector<std::optional<std::string>> bad_lines(opts.paths.size());
+  std::atomic<std::size_t> next = 0;
+  {
+    std::vector<std::jthread> threads;
+    for (std::size_t w = 0; w < workers; w++) {
+      threads.emplace_back([&, w] {
+        for (std::size_t i; (i = next++) < opts.paths.size();) {
+          bad_lines[i] = analyze_day(opts.paths[i], partial[w]);
+        }
+      });
+    }
+  }
+  pc_club::client_analytics total;
+  for (const auto& p : partial) {
+    total.merge(p);
+  }
 
-  if (open > close || open == -1 || close == -1) {
-    std::cout << line << '\n';
-    return false;
+  int status = 0;
+  for (std::size_t i = 0; i < opts.paths.size(); i++) {
+    if (bad_lines[i]) {
+      std::cerr << opts.paths[i] << ": " << *bad_lines[i] << '\n';
+      status = 1;
+    }
+  }
+  for (const auto& [name, stats] : total.top_spenders(opts.top)) {
+    std::cout << name << ' ' << stats.spend << ' ' << std::setfill('0') << std::setw(2) << stats.seat_time / 60 << ':'
+              << std::setw(2) << stats.seat_time % 60 << ' ' << stats.waits << ' ' << stats.turn_aways << '\n';
   }
+  return status;
+}
 
-  std::getline(fin, line);
-  try {
-    price = std::stoi(line);
-  } catch (...) {
-    std::cout << line << '\n';
-    return false;
+// Parses the day once and prints the totals of every table count and price combination.
+int run_sweep_mode(const options& opts) {
+  std::string input = pc_club::read_file_contents(opts.paths.front());
+  std::string_view section = input;
+  pc_club::club_parameters club{};
+  if (std::string bad_line; !pc_club::read_parameters(section, club, bad_line)) {
+    std::cout << bad_line << '\n';
+    return 1;
   }
-  if (price <= 0) {
-    std::cout << line << '\n';
-    return false;
+  std::optional<std::string> bad_line;
+  const auto events = pc_club::parse_events_parallel(section, club.tables, bad_line);
+  if (bad_line) {
+    std::cout << *bad_line << '\n';
+    return 1;
   }
-  return true;
+
+  std::vector<std::int32_t> tables = opts.sweep_tables.empty() ? std::vector{club.tables} : opts.sweep_tables;
+  std::vector<std::int32_t> prices = opts.sweep_prices.empty() ? std::vector{club.price} : opts.sweep_prices;
+  if (*std::min_element(tables.begin(), tables.end()) < club.tables) {
+    std::cerr << "Cannot sweep below the " << club.tables << " tables the input refers to\n";
+    return 1;
+  }
+  std::vector<pc_club::sweep_config> configs;
+  for (std::int32_t t : tables) {
+    for (std::int32_t p : prices) {
+      configs.push_back({.tables = t, .price = p});
+    }
+  }
+
+  std::cout << std::setw(6) << "tables" << std::setw(8) << "price" << std::setw(12) << "revenue" << std::setw(10)
+            << "usage" << std::setw(11) << "turn_aways" << std::setw(8) << "errors" << '\n';
+  for (const auto& [config, totals] : pc_club::run_sweep(events, club, configs)) {
+    std::string usage = std::to_string(totals.usage / 60) + ':' + static_cast<char>('0' + totals.usage % 60 / 10) +
+                        static_cast<char>('0' + totals.usage % 10);
+    std::cout << std::setw(6) << config.tables << std::setw(8) << config.price << std::setw(12) << totals.revenue
+              << std::setw(10) << usage << std::setw(11) << totals.turn_aways << std::setw(8) << totals.errors << '\n';
+  }
+  return 0;
 }
-} // namespace
 
-int main(int argc, char* argv[]) {
-  if (argc != 2) {
-    std::cout << "Usage: " << argv[0] << " <path_to_file>\n";
+int run_build_index(const options& opts) {
+  const std::string path = opts.paths.front();
+  pc_club::time_index index;
+  std::string input = pc_club::read_file_contents(path);
+  if (std::string bad_line; !pc_club::build_time_index(input, opts.index_interval, index, bad_line)) {
+    std::cout << bad_line << '\n';
+    return 1;
+  }
+  std::ofstream out(pc_club::index_path(path));
+  pc_club::write_time_index(out, index);
+  if (!out.flush()) {
+    std::cerr << "Failed to write " << pc_club::index_path(path) << '\n';
     return 1;
   }
+  return 0;
+}
 
-  auto fin = std::fstream(argv[1], std::ios::in);
+// Replays the day from `opts.from`: the processor resumes from the index's last checkpoint before it
+// (or from opening time without a usable index) and prints nothing until that minute.
+int run_from(const options& opts) {
+  const pc_club::output_encoder encoder(opts.format);
+  std::string out;
+  encoder.begin(out);
+  std::cout << out;
 
+  const std::string path = opts.paths.front();
+  std::ifstream in(path, std::ios::binary);
+  std::string header;
   std::string line;
+  for (int i = 0; i < 3 && std::getline(in, line); i++) {
+    header += line;
+    header += '\n';
+  }
+  std::string_view rest = header;
+  pc_club::club_parameters club{};
+  if (std::string bad_line; !pc_club::read_parameters(rest, club, bad_line)) {
+    out.clear();
+    encoder.input_error(out, bad_line);
+    std::cout << out;
+    return 1;
+  }
 
-  std::int32_t open = 0, close = 0, tables = 0, price = 0;
+  std::optional<pc_club::time_index> index;
+  if (std::ifstream index_in(pc_club::index_path(path)); index_in) {
+    index = pc_club::read_time_index(index_in);
+  }
+  std::error_code ec;
+  auto size = std::filesystem::file_size(path, ec);
+  const pc_club::checkpoint* resume = nullptr;
+  if (index && !ec && index->input_size == size && index->header == header) {
+    resume = index->find(opts.from);
+  }
 
-  if (!get_parameters(fin, line, open, close, tables, price)) {
+  std::optional<std::string> bad_line;
+  std::ostream discard(nullptr);
+  pc_club::with_event_processor(
+      club.tables,
+      club.price,
+      club.open_time,
+      club.close_time,
+      discard,
+      pc_club::output_format::none,
+      [&](auto& ep) {
+        if (resume) {
+          try {
+            ep.restore(resume->state);
+            in.seekg(static_cast<std::streamoff>(resume->offset));
+          } catch (const std::invalid_argument&) {
+            // The checkpoint does not fit this club after all: replay the day from its start.
+            ep.begin_day(club.open_time, club.close_time);
+          }
+        }
+        auto lines = pc_club::read_lines(in);
+        auto events = pc_club::parse_events(lines, club.tables, bad_line);
+        bool live = false;
+        for (const auto& e : events) {
+          if (!live && e.time >= opts.from) {
+            ep.set_output(std::cout, opts.format);
+            live = true;
+          }
+          ep.process_event(e);
+        }
+        if (!live) {
+          ep.set_output(std::cout, opts.format);
+        }
+        if (!bad_line) {
+          ep.close();
+        }
+      }
+  );
+  if (bad_line) {
+    out.clear();
+    encoder.input_error(out, *bad_line);
+    std::cout << out;
     return 1;
   }
+  return 0;
+}
 
-  std::vector<pc_club::event> events;
-  while (std::getline(fin, line)) {
-    std::vector<std::string> tokens;
-    std::istringstream iss(line);
-    std::string token;
+bool write_heatmap(const options& opts, const pc_club::occupancy_heatmap& heatmap) {
+  std::ofstream out(opts.heatmap_path, std::ios::binary);
+  if (opts.heatmap_binary) {
+    heatmap.write_binary(out);
+  } else {
+    heatmap.write_csv(out);
+  }
+  if (!out.flush()) {
+    std::cerr << "Failed to write " << opts.heatmap_path << '\n';
+    return false;
+  }
+  return true;
+}
+
+int run(const options& opts, pc_club::trace_recorder* tracer) {
+  const pc_club::output_encoder encoder(opts.format);
+  auto report = [&encoder](std::string_view line) {
+    std::string out;
+    encoder.input_error(out, line);
+    std::cout << out;
+  };
+  {
+    std::string out;
+    encoder.begin(out);
+    std::cout << out;
+  }
+
+  pc_club::club_parameters club{};
+  std::optional<std::string> bad_line;
+
+  std::optional<pc_club::occupancy_heatmap> heatmap;
+  int status = 0;
+
+  auto with_processor = [&](auto&& f) {
+    if (opts.heatmap_path) {
+      heatmap.emplace(club.tables);
+    }
+    pc_club::with_event_processor(
+        club.tables,
+        club.price,
+        club.open_time,
+        club.close_time,
+        std::cout,
+        opts.format,
+        [&](auto& ep) {
+          ep.set_heatmap(heatmap ? &*heatmap : nullptr);
+          ep.set_journal(opts.corrections);
+          f(ep);
+        }
+    );
+  };
+  auto finish = [&](auto& ep) {
+    if (bad_line) {
+      return;
+    }
+    {
+      pc_club::trace_span span(tracer, "close");
+      ep.close();
+      std::cout.flush();
+    }
+    if (heatmap && !write_heatmap(opts, *heatmap)) {
+      status = 1;
+    }
+  };
 
-    while (iss >> token) {
-      tokens.push_back(token);
+  if (!opts.stream && opts.paths.size() == 1) {
+    // Whole input in memory: the event lines are parsed on all cores before any of them is processed.
+    std::string input;
+    {
+      pc_club::trace_span span(tracer, "read");
+      input = pc_club::read_file_contents(opts.paths.front());
+    }
+    std::string_view section = input;
+    {
+      pc_club::trace_span span(tracer, "get_parameters");
+      if (std::string header_bad_line; !pc_club::read_parameters(section, club, header_bad_line)) {
+        report(header_bad_line);
+        return 1;
+      }
+    }
+    std::vector<pc_club::event> parsed;
+    {
+      pc_club::trace_span span(tracer, "parse");
+      parsed = pc_club::parse_events_parallel(section, club.tables, bad_line, {.corrections = opts.corrections});
     }
-    pc_club::event e;
-    if (!get_event(line, tables, tokens, e)) {
-      std::cout << line << '\n';
+    if (bad_line) {
+      report(*bad_line);
       return 1;
     }
-    events.emplace_back(e);
+    if (opts.parallel && !opts.heatmap_path && !opts.corrections && !tracer) {
+      // Only the encoding runs on other cores while the pre-pass processes the day in order, so this costs
+      // more CPU than the loop below and is opt-in. The heatmap is filled by a single processor, a
+      // retraction may reach back into an earlier segment and the trace has per-event and close spans,
+      // so these keep the loop below.
+      pc_club::trace_span span(tracer, "process");
+      pc_club::replay_parallel(parsed, club, std::cout, opts.format);
+      std::cout.flush();
+      return status;
+    }
+    with_processor([&](auto& ep) {
+      {
+        pc_club::trace_span span(tracer, "process");
+        if (tracer) {
+          // A traced run samples every n-th event, so it goes one event at a time.
+          for (const auto& e : parsed) {
+            pc_club::trace_span event_span(tracer->sample() ? tracer : nullptr, event_span_name(e.type));
+            ep.process_event(e);
+          }
+        } else {
+          // Batches keep the output writes off the per-event path.
+          constexpr std::size_t batch_size = 4096;
+          std::span<const pc_club::event> all(parsed);
+          for (std::size_t i = 0; i < all.size(); i += batch_size) {
+            ep.process_events(all.subspan(i, std::min(batch_size, all.size() - i)));
+          }
+        }
+      }
+      finish(ep);
+    });
+    return status;
   }
 
-  pc_club::event_processor ep(tables, price, open, close);
-  for (const auto& e : events) {
-    ep.process_event(e);
+  pc_club::follow_options follow;
+  std::vector<pc_club::line_source> logs;
+  logs.reserve(opts.paths.size());
+  for (const char* path : opts.paths) {
+    logs.push_back(opts.follow ? pc_club::follow_file_lines(path, follow) : pc_club::read_file_lines(path));
   }
-  ep.close();
+  {
+    pc_club::trace_span span(tracer, "get_parameters");
+    for (std::size_t i = 0; i < logs.size(); i++) {
+      pc_club::club_parameters log_club{};
+      if (std::string header_bad_line; !pc_club::read_parameters(logs[i], log_club, header_bad_line)) {
+        report(header_bad_line);
+        return 1;
+      }
+      if (i == 0) {
+        club = log_club;
+      } else if (std::tie(log_club.tables, log_club.price, log_club.open_time, log_club.close_time) !=
+                 std::tie(club.tables, club.price, club.open_time, club.close_time)) {
+        std::cerr << opts.paths[i] << ": the club differs from " << opts.paths.front() << '\n';
+        return 1;
+      }
+    }
+  }
+  follow.deadline = pc_club::today_at(club.close_time);
 
-  return 0;
+  // Constant memory: events are processed as they are parsed, so output preceding a malformed line
+  // has already been written when it is reported. The logs of several terminals are merged by time.
+  std::vector<pc_club::generator<pc_club::event>> parsed;
+  for (auto& log : logs) {
+    parsed.push_back(pc_club::parse_events(log, club.tables, bad_line, opts.corrections));
+  }
+  auto events = parsed.size() == 1 ? std::move(parsed.front()) : pc_club::merge_events(parsed, bad_line);
+  with_processor([&](auto& ep) {
+    {
+      pc_club::trace_span span(tracer, "process");
+      for (const auto& e : events) {
+        pc_club::trace_span event_span(tracer && tracer->sample() ? tracer : nullptr, event_span_name(e.type));
+        ep.process_event(e);
+        if (opts.follow) {
+          std::cout.flush();
+        }
+      }
+    }
+    finish(ep);
+  });
+  if (bad_line) {
+    report(*bad_line);
+    return 1;
+  }
+  return status;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  options opts;
+  if (!parse_options(argc, argv, opts)) {
+    std::cout << "Usage: " << argv[0]
+              << " [--stream | --follow | --parallel] [--format text|csv|jsonl|binary|none] [--trace <trace.json>] [--trace-sample <n>]"
+                 " [--heatmap <file> [--heatmap-format csv|binary]] [--corrections] <path_to_file|->...\n"
+              << "       " << argv[0] << " --top <k> <path_to_file>...\n"
+              << "       " << argv[0] << " [--sweep-tables <n,...>] [--sweep-prices <p,...>] <path_to_file>\n"
+              << "       " << argv[0] << " --build-index [--index-interval <minutes>] <path_to_file>\n"
+              << "       " << argv[0] << " --from <HH:MM> [--format <format>] <path_to_file>\n"
+              << "--parallel only encodes the output of long days on other cores: it helps when encoding dominates,\n"
+                 "costs up to twice the CPU time and gains nothing with --format none.\n";
+    return 1;
+  }
+
+  std::optional<pc_club::trace_recorder> recorder;
+  if (opts.trace_path) {
+    recorder.emplace(opts.trace_sample);
+  }
+
+  int status = 0;
+  if (opts.top != 0) {
+    status = run_analytics(opts);
+  } else if (!opts.sweep_tables.empty() || !opts.sweep_prices.empty()) {
+    status = run_sweep_mode(opts);
+  } else if (opts.build_index) {
+    status = run_build_index(opts);
+  } else if (opts.from >= 0) {
+    status = run_from(opts);
+  } else {
+    status = run(opts, recorder ? &*recorder : nullptr);
+  }
+
+  if (recorder) {
+    std::cout.flush();
+    if (!recorder->write(opts.trace_path)) {
+      std::cerr << "Failed to write trace to " << opts.trace_path << '\n';
+    }
+  }
+  return status;
 }
@@ -0,0 +1,127 @@
+#include "event_processor.h"
+#include "workload.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <streambuf>
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> allocated_bytes{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+class null_buf : public std::streambuf {
+protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    return c;
+  }
+};
+
+struct counters {
+  std::size_t events = 0;
+  std::size_t allocations = 0;
+  std::size_t bytes = 0;
+};
+
+void report(const char* phase, const std::array<counters, 5>& by_type) {
+  constexpr const char* names[] = {"", "enter", "take", "wait", "leave"};
+  std::printf("%s\n%-8s %10s %12s %14s %12s\n", phase, "type", "events", "allocations", "bytes", "allocs/event");
+  for (std::size_t type = 1; type < by_type.size(); type++) {
+    const counters& c = by_type[type];
+    std::printf(
+        "%-8s %10zu %12zu %14zu %12.4f\n",
+        names[type],
+        c.events,
+        c.allocations,
+        c.bytes,
+        c.events == 0 ? 0.0 : static_cast<double>(c.allocations) / static_cast<double>(c.events)
+    );
+  }
+}
+} // namespace
+
+// Heap allocations and bytes per event type, for the first half of a synthetic day (warm-up) and
+// for the second half (steady state).
+int main(int argc, char* argv[]) {
+  std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200'000;
+  std::int32_t tables = argc > 2 ? static_cast<std::int32_t>(std::strtol(argv[2], nullptr, 10)) : 20;
+  if (count == 0 || tables <= 0) {
+    std::printf("Usage: %s [events] [tables]\n", argv[0]);
+    return 1;
+  }
+  const auto events = pc_club::bench::make_workload(count, tables, 0, 24 * 60 - 1);
+
+  null_buf sink_buf;
+  std::ostream sink(&sink_buf);
+  pc_club::event_processor processor(tables, 100, 0, 24 * 60 - 1, sink);
+  std::array<std::array<counters, 5>, 2> phases{};
+  for (std::size_t i = 0; i < events.size(); i++) {
+    const auto& e = events[i];
+    std::size_t allocations_before = allocations.load();
+    std::size_t bytes_before = allocated_bytes.load();
+    processor.process_event(e);
+    counters& c = phases[i < events.size() / 2][static_cast<std::size_t>(e.type)];
+    c.events++;
+    c.allocations += allocations.load() - allocations_before;
+    c.bytes += allocated_bytes.load() - bytes_before;
+  }
+  report("warm-up (first half)", phases[1]);
+  report("steady state (second half)", phases[0]);
+
+  const pc_club::processor_memory memory = processor.memory_report();
+  std::printf(
+      "memory: records %zu, names %zu, name index %zu, table index %zu, queue %zu, tables %zu, buffer %zu, total %zu "
+      "bytes\n",
+      memory.client_records,
+      memory.client_names,
+      memory.name_index,
+      memory.table_index,
+      memory.queue,
+      memory.tables,
+      memory.output_buffer,
+      memory.total()
+  );
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include "bimap.h"
+#include "compact-bimap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// One step of a client-to-table seating: who acts, and at which table.
+struct step {
+  enum class kind : std::uint8_t { seat, move, leave, lookup };
+
+  kind what;
+  std::int32_t client;
+  std::int32_t table;
+};
+
+std::vector<step> make_steps(std::size_t count, std::int32_t tables) {
+  std::mt19937 rng(42);
+  std::vector<step> steps;
+  steps.reserve(count);
+  const std::int32_t clients = tables * 4;
+  for (std::size_t i = 0; i < count; i++) {
+    steps.push_back({
+        .what = static_cast<step::kind>(rng() % 4),
+        .client = static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(clients)),
+        .table = 1 + static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(tables))
+    });
+  }
+  return steps;
+}
+
+// Keeps a name-to-table bimap the way the processor once kept its seating: a table holds one client
+// and a client one table. Returns a checksum of the lookups, so the containers can be compared.
+template <typename Map>
+std::int64_t seat_clients(Map& seating, const std::vector<step>& steps, const std::vector<std::string>& names) {
+  std::int64_t checksum = 0;
+  for (const step& s : steps) {
+    const std::string& name = names[static_cast<std::size_t>(s.client)];
+    switch (s.what) {
+    case step::kind::seat:
+      seating.insert(name, s.table);
+      break;
+    case step::kind::move:
+      if (auto it = seating.find_left(name); it != seating.end_left()) {
+        seating.replace_right(it, s.table);
+      }
+      break;
+    case step::kind::leave:
+      seating.erase_left(name);
+      break;
+    case step::kind::lookup:
+      if (auto it = seating.find_right(s.table); it != seating.end_right()) {
+        checksum += static_cast<std::int64_t>(it.flip()->size());
+      }
+      break;
+    }
+  }
+  for (auto it = seating.begin_right(); it != seating.end_right(); ++it) {
+    checksum += *it;
+  }
+  return checksum;
+}
+
+template <typename F>
+double measure(int repeats, F&& f) {
+  double best = 0;
+  for (int i = 0; i < repeats; i++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = i == 0 ? seconds : std::min(best, seconds);
+  }
+  return best;
+}
+} // namespace
+
+// Compares the pointer-linked `bimap` with the index-linked `compact_bimap` on the same seating steps.
+int main(int argc, char* argv[]) {
+  std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  std::int32_t tables = argc > 2 ? static_cast<std::int32_t>(std::strtol(argv[2], nullptr, 10)) : 10'000;
+  int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+  if (count == 0 || tables <= 0 || repeats <= 0) {
+    std::cout << "Usage: " << argv[0] << " [steps] [tables] [repeats]\n";
+    return 1;
+  }
+
+  const auto steps = make_steps(count, tables);
+  std::vector<std::string> names;
+  for (std::int32_t i = 0; i < tables * 4; i++) {
+    names.push_back("client_" + std::to_string(i));
+  }
+
+  std::int64_t pointer_checksum = 0;
+  std::int64_t compact_checksum = 0;
+  bimap<std::string, std::int32_t> pointer;
+  compact_bimap<std::string, std::int32_t> compact;
+  double pointer_time = measure(repeats, [&] {
+    pointer.clear();
+    pointer_checksum = seat_clients(pointer, steps, names);
+  });
+  double compact_time = measure(repeats, [&] {
+    compact.clear();
+    compact_checksum = seat_clients(compact, steps, names);
+  });
+
+  if (pointer_checksum != compact_checksum || pointer.size() != compact.size()) {
+    std::cerr << "Containers disagree: " << pointer_checksum << " vs " << compact_checksum << '\n';
+    return 1;
+  }
+  auto per_step = [&](double seconds) {
+    return seconds * 1e9 / static_cast<double>(count);
+  };
+  const auto pointer_stats = pointer.stats();
+  const auto compact_stats = compact.stats();
+  std::cout << "steps: " << count << ", tables: " << tables << ", seated at the end: " << pointer.size() << '\n';
+  // bimap's erase hangs a removed node's right subtree under its predecessor, so churn deepens the trees.
+  std::cout << "bimap:         " << per_step(pointer_time) << " ns/step, " << pointer_stats.node_bytes
+            << " bytes/node, " << pointer_stats.total_bytes << " bytes, tree heights " << pointer_stats.left.height
+            << '/' << pointer_stats.right.height << '\n';
+  std::cout << "compact_bimap: " << per_step(compact_time) << " ns/step, " << compact_stats.node_bytes
+            << " bytes/node, " << compact_stats.total_bytes << " bytes\n";
+  return 0;
+}
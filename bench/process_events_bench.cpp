@@ -0,0 +1,89 @@
+#include "event_processor.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+
+namespace {
+// Counts the bytes instead of storing them, so the run measures processing rather than I/O.
+class counting_buf : public std::streambuf {
+public:
+  std::size_t count() const {
+    return _count;
+  }
+
+protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    _count += static_cast<std::size_t>(n);
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    _count++;
+    return c;
+  }
+
+private:
+  std::size_t _count = 0;
+};
+
+template <typename F>
+double measure(int repeats, F&& f) {
+  double best = 0;
+  for (int i = 0; i < repeats; i++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best = i == 0 ? seconds : std::min(best, seconds);
+  }
+  return best;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  std::int32_t tables = argc > 2 ? static_cast<std::int32_t>(std::strtol(argv[2], nullptr, 10)) : 100;
+  int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+  if (count == 0 || tables <= 0 || repeats <= 0) {
+    std::cout << "Usage: " << argv[0] << " [events] [tables] [repeats]\n";
+    return 1;
+  }
+
+  constexpr std::int32_t open_time = 0;
+  constexpr std::int32_t close_time = 24 * 60 - 1;
+  const auto events = pc_club::bench::make_workload(count, tables, open_time, close_time);
+
+  counting_buf single_buf;
+  counting_buf batch_buf;
+  std::ostream single_out(&single_buf);
+  std::ostream batch_out(&batch_buf);
+
+  double single = measure(repeats, [&] {
+    pc_club::event_processor ep(tables, 100, open_time, close_time, single_out);
+    for (const auto& e : events) {
+      ep.process_event(e);
+    }
+    ep.close();
+  });
+  double batch = measure(repeats, [&] {
+    pc_club::event_processor ep(tables, 100, open_time, close_time, batch_out);
+    ep.process_events(events);
+    ep.close();
+  });
+
+  if (single_buf.count() != batch_buf.count()) {
+    std::cerr << "Output size mismatch: " << single_buf.count() << " vs " << batch_buf.count() << '\n';
+    return 1;
+  }
+  auto rate = [count](double seconds) {
+    return static_cast<double>(count) / seconds / 1e6;
+  };
+  std::cout << "events: " << count << ", tables: " << tables << '\n';
+  std::cout << "process_event:  " << rate(single) << " M events/s\n";
+  std::cout << "process_events: " << rate(batch) << " M events/s (x" << single / batch << ")\n";
+  return 0;
+}
@@ -0,0 +1,223 @@
+#include "event_parser.h"
+#include "event_processor.h"
+#include "event_source.h"
+#include "output_encoder.h"
+#include "parallel_parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+using steady = std::chrono::steady_clock;
+
+struct options {
+  const char* path = nullptr;
+  // Event time runs `speedup` times faster than real time, unless `rate` fixes the events per second.
+  double speedup = 1;
+  double rate = 0;
+  // CPUs to pin the feeding and the processing thread to; -1 leaves them unpinned.
+  int feeder_cpu = -1;
+  int processor_cpu = -1;
+  pc_club::output_format format = pc_club::output_format::text;
+};
+
+bool parse_options(int argc, char* argv[], options& opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--realtime") {
+      opts.speedup = 1;
+      opts.rate = 0;
+    } else if (arg == "--speedup" && i + 1 < argc) {
+      opts.speedup = std::strtod(argv[++i], nullptr);
+      opts.rate = 0;
+      if (!(opts.speedup > 0)) {
+        return false;
+      }
+    } else if (arg == "--rate" && i + 1 < argc) {
+      opts.rate = std::strtod(argv[++i], nullptr);
+      if (!(opts.rate > 0)) {
+        return false;
+      }
+    } else if (arg == "--pin-feeder" && i + 1 < argc) {
+      opts.feeder_cpu = std::atoi(argv[++i]);
+    } else if (arg == "--pin-processor" && i + 1 < argc) {
+      opts.processor_cpu = std::atoi(argv[++i]);
+    } else if (arg == "--format" && i + 1 < argc) {
+      if (!pc_club::parse_output_format(argv[++i], opts.format)) {
+        return false;
+      }
+    } else if (opts.path == nullptr) {
+      opts.path = argv[i];
+    } else {
+      return false;
+    }
+  }
+  return opts.path != nullptr;
+}
+
+// Counts the bytes instead of storing them, so the run measures processing and encoding rather than I/O.
+class counting_buf : public std::streambuf {
+public:
+  std::size_t count() const {
+    return _count;
+  }
+
+protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    _count += static_cast<std::size_t>(n);
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    _count++;
+    return c;
+  }
+
+private:
+  std::size_t _count = 0;
+};
+
+void pin_current_thread(int cpu, const char* role) {
+  if (cpu < 0) {
+    return;
+  }
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+    return;
+  }
+#endif
+  std::cerr << "Could not pin the " << role << " thread to CPU " << cpu << '\n';
+}
+
+// When each event is due, relative to the start of the replay.
+std::vector<steady::duration> schedule(const std::vector<pc_club::event>& events, const options& opts) {
+  std::vector<steady::duration> due(events.size());
+  for (std::size_t i = 0; i < events.size(); i++) {
+    double seconds = opts.rate > 0 ? static_cast<double>(i) / opts.rate
+                                   : (events[i].time - events.front().time) * 60.0 / opts.speedup;
+    due[i] = std::chrono::duration_cast<steady::duration>(std::chrono::duration<double>(seconds));
+  }
+  return due;
+}
+
+// Sleeps until shortly before `deadline`, then yields until it passes: sleeping alone overshoots
+// by more than the latencies being measured.
+void wait_until(steady::time_point deadline) {
+  constexpr auto slack = std::chrono::microseconds(100);
+  if (deadline - steady::now() > 2 * slack) {
+    std::this_thread::sleep_until(deadline - slack);
+  }
+  while (steady::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
+double percentile(const std::vector<std::int64_t>& sorted, double q) {
+  std::size_t rank = static_cast<std::size_t>(q * static_cast<double>(sorted.size()));
+  return static_cast<double>(sorted[std::min(rank, sorted.size() - 1)]) / 1e3;
+}
+} // namespace
+
+// Feeds a day to the processor at a controlled pace and reports the latency of every event from the
+// moment it was due to the moment its output was encoded. Latency is measured from the schedule, not
+// from when the feeder got to the event, so a processor that falls behind is charged for the backlog.
+int main(int argc, char* argv[]) {
+  options opts;
+  if (!parse_options(argc, argv, opts)) {
+    std::cout << "Usage: " << argv[0]
+              << " [--realtime | --speedup <n> | --rate <events/s>] [--pin-feeder <cpu>] [--pin-processor <cpu>]"
+                 " [--format <format>] <path_to_file>\n";
+    return 1;
+  }
+
+  std::string input = pc_club::read_file_contents(opts.path);
+  std::string_view section = input;
+  pc_club::club_parameters club{};
+  if (std::string bad_line; !pc_club::read_parameters(section, club, bad_line)) {
+    std::cout << bad_line << '\n';
+    return 1;
+  }
+  std::optional<std::string> bad_line;
+  const auto events = pc_club::parse_events_parallel(section, club.tables, bad_line);
+  if (bad_line) {
+    std::cout << *bad_line << '\n';
+    return 1;
+  }
+  if (events.empty()) {
+    std::cout << "No events to replay\n";
+    return 1;
+  }
+
+  const auto due = schedule(events, opts);
+  std::vector<std::int64_t> latencies(events.size());
+  // Events up to this index have been handed to the processor.
+  std::atomic<std::size_t> released = 0;
+  const steady::time_point start = steady::now() + std::chrono::milliseconds(10);
+  counting_buf sink;
+  std::ostream out(&sink);
+
+  std::jthread processor([&] {
+    pin_current_thread(opts.processor_cpu, "processor");
+    pc_club::with_event_processor(
+        club.tables,
+        club.price,
+        club.open_time,
+        club.close_time,
+        out,
+        opts.format,
+        [&](auto& ep) {
+          for (std::size_t done = 0; done < events.size();) {
+            std::size_t ready = released.load(std::memory_order_acquire);
+            if (ready == done) {
+              std::this_thread::yield();
+              continue;
+            }
+            for (; done < ready; done++) {
+              ep.process_event(events[done]);
+              latencies[done] = std::chrono::nanoseconds(steady::now() - (start + due[done])).count();
+            }
+          }
+          ep.close();
+        }
+    );
+  });
+
+  pin_current_thread(opts.feeder_cpu, "feeder");
+  for (std::size_t i = 0; i < events.size(); i++) {
+    wait_until(start + due[i]);
+    released.store(i + 1, std::memory_order_release);
+  }
+  processor.join();
+  const double elapsed = std::chrono::duration<double>(steady::now() - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << "events: " << events.size() << ", pace: ";
+  if (opts.rate > 0) {
+    std::cout << opts.rate << " events/s\n";
+  } else {
+    std::cout << opts.speedup << "x real time\n";
+  }
+  std::cout << "elapsed: " << elapsed << " s, " << static_cast<double>(events.size()) / elapsed << " events/s, "
+            << sink.count() << " bytes of output\n";
+  std::cout << "latency us: p50 " << percentile(latencies, 0.5) << ", p99 " << percentile(latencies, 0.99) << ", p999 "
+            << percentile(latencies, 0.999) << ", max " << percentile(latencies, 1) << '\n';
+  return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef __workload_h_
+#define __workload_h_
+
+#include "event_processor.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace pc_club::bench {
+// A deterministic synthetic day: clients arrive, sit down, move, queue and leave in time order,
+// with a share of invalid requests so the error paths are exercised too.
+inline std::vector<event> make_workload(std::size_t count, std::int32_t tables, std::int32_t open_time, std::int32_t close_time) {
+  std::mt19937 rng(42);
+  std::vector<event> events;
+  events.reserve(count);
+  const std::int32_t clients = tables * 4;
+  for (std::size_t i = 0; i < count; i++) {
+    event e{};
+    e.time = open_time + static_cast<std::int32_t>(i * static_cast<std::size_t>(close_time - open_time) / count);
+    e.type = static_cast<event_type>(1 + rng() % 4);
+    e.name = "client_" + std::to_string(rng() % clients);
+    e.name_hash = hash_name(e.name);
+    e.table = e.type == event_type::take ? 1 + static_cast<std::int32_t>(rng() % tables) : 0;
+    events.push_back(std::move(e));
+  }
+  return events;
+}
+} // namespace pc_club::bench
+
+#endif // !__workload_h_
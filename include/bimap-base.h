@@ -3,7 +3,12 @@
 #include "bimap-element.h"
 #include "bimap-iterator.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #ifdef _MSC_VER
 #define MY_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
@@ -12,6 +17,15 @@
 #endif
 
 namespace bimap_impl {
+// Shape of one side's tree: a lookup makes about `average_depth` comparisons, and `height` at worst.
+struct tree_stats {
+  std::size_t height = 0;
+  double average_depth = 0;
+  // `height` over the height of a perfectly balanced tree with as many nodes: 1 when balanced, up to
+  // n / log2(n) for a tree degenerated into a list.
+  double imbalance = 0;
+};
+
 template <typename Iterator, typename Compare>
 class bimap_base {
   using tag = typename Iterator::tag;
@@ -33,6 +47,8 @@ protected:
   iterator erase(iterator it) noexcept {
     auto node = it._node, parent = node->parent, left = node->left, right = node->right;
     auto next = std::next(it);
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
     if (_sentinel->left == node) {
       _sentinel->left = next._node;
     }
@@ -63,6 +79,7 @@ protected:
   }
 
   iterator emplace_hint(iterator hint, node_t* node) noexcept {
+    node_base* successor = hint._node;
     if (_sentinel->right == _sentinel) { // empty
       _sentinel->right = _sentinel->left = _sentinel->parent = node;
       node->parent = nullptr;
@@ -84,9 +101,38 @@ protected:
       }
       node->parent = hint._node;
     }
+    node->next = successor;
+    node->prev = successor->prev;
+    node->prev->next = node;
+    successor->prev = node;
     return iterator(node);
   }
 
+  // Links `count` nodes, already ordered by this side's key, into a balanced tree in O(count).
+  template <typename Binode>
+  void assign_sorted(Binode* const* nodes, std::size_t count) noexcept {
+    if (count == 0) {
+      reset();
+      return;
+    }
+    node_base* prev = _sentinel;
+    for (std::size_t i = 0; i < count; i++) {
+      node_base* current = static_cast<node_t*>(nodes[i]);
+      current->prev = prev;
+      prev->next = current;
+      prev = current;
+    }
+    prev->next = _sentinel;
+    _sentinel->prev = prev;
+    node_base* root = build(nodes, 0, count);
+    root->parent = nullptr;
+    node_base* last = static_cast<node_t*>(nodes[count - 1]);
+    last->right = _sentinel;
+    _sentinel->right = root;
+    _sentinel->left = static_cast<node_t*>(nodes[0]);
+    _sentinel->parent = last;
+  }
+
   iterator lower_bound(const type& value) const {
     node_base *current = _sentinel->right, *bound = _sentinel;
     if (_sentinel->right == _sentinel || compare(*std::prev(end()), value)) {
@@ -161,7 +207,11 @@ protected:
     if (lhs._sentinel->parent == rhs._sentinel) {
       lhs._sentinel->parent = lhs._sentinel;
     }
+    if (lhs._sentinel->next == rhs._sentinel) {
+      lhs._sentinel->next = lhs._sentinel->prev = lhs._sentinel;
+    }
     lhs._sentinel->parent->right = lhs._sentinel;
+    lhs._sentinel->next->prev = lhs._sentinel->prev->next = lhs._sentinel;
     if (rhs._sentinel->left == lhs._sentinel) {
       rhs._sentinel->left = rhs._sentinel;
     }
@@ -171,7 +221,11 @@ protected:
     if (rhs._sentinel->parent == lhs._sentinel) {
       rhs._sentinel->parent = rhs._sentinel;
     }
+    if (rhs._sentinel->next == lhs._sentinel) {
+      rhs._sentinel->next = rhs._sentinel->prev = rhs._sentinel;
+    }
     rhs._sentinel->parent->right = rhs._sentinel;
+    rhs._sentinel->next->prev = rhs._sentinel->prev->next = rhs._sentinel;
   }
 
   static void move(node_no_data_t* ths, node_no_data_t* thr) {
@@ -184,14 +238,70 @@ protected:
     if (ths->parent == thr) {
       ths->parent = ths;
     }
+    if (ths->next == thr) {
+      ths->next = ths->prev = ths;
+    }
     ths->parent->right = ths;
+    ths->next->prev = ths->prev->next = ths;
     thr->parent = thr->left = thr->right = thr;
+    thr->prev = thr->next = thr;
+  }
+
+  void reset() noexcept {
+    _sentinel->left = _sentinel->right = _sentinel->parent = _sentinel;
+    _sentinel->prev = _sentinel->next = _sentinel;
   }
 
   node_no_data_t* sentinel() {
     return _sentinel;
   }
 
+  // Walks the whole tree; meant for diagnostics, not for hot paths.
+  tree_stats shape() const {
+    tree_stats stats;
+    if (_sentinel->right == _sentinel) {
+      return stats;
+    }
+    std::size_t nodes = 0;
+    std::size_t depths = 0;
+    std::vector<std::pair<const node_base*, std::size_t>> pending{{_sentinel->right, 1}};
+    while (!pending.empty()) {
+      auto [current, depth] = pending.back();
+      pending.pop_back();
+      nodes++;
+      depths += depth;
+      stats.height = std::max(stats.height, depth);
+      // The last node's right link is the sentinel.
+      for (const node_base* child : {current->left, current->right}) {
+        if (child != nullptr && child != _sentinel) {
+          pending.emplace_back(child, depth + 1);
+        }
+      }
+    }
+    stats.average_depth = static_cast<double>(depths) / static_cast<double>(nodes);
+    stats.imbalance = static_cast<double>(stats.height) / static_cast<double>(std::bit_width(nodes));
+    return stats;
+  }
+
+private:
+  template <typename Binode>
+  static node_base* build(Binode* const* nodes, std::size_t first, std::size_t last) noexcept {
+    if (first == last) {
+      return nullptr;
+    }
+    std::size_t mid = first + (last - first) / 2;
+    node_base* root = static_cast<node_t*>(nodes[mid]);
+    root->left = build(nodes, first, mid);
+    root->right = build(nodes, mid + 1, last);
+    if (root->left) {
+      root->left->parent = root;
+    }
+    if (root->right) {
+      root->right->parent = root;
+    }
+    return root;
+  }
+
 private:
   node_no_data_t* _sentinel{};
   MY_NO_UNIQUE_ADDRESS mutable Compare _compare;
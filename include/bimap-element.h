@@ -7,13 +7,17 @@ class right;
 
 struct node_base {
   node_base *left{this}, *right{this}, *parent{this};
+  // In-order neighbours; the sentinel closes the list, so its `next` is the first node and `prev` the last.
+  node_base *prev{this}, *next{this};
 
   node_base() = default;
 
   explicit node_base(std::nullptr_t)
       : left{nullptr}
       , right{nullptr}
-      , parent{nullptr} {}
+      , parent{nullptr}
+      , prev{nullptr}
+      , next{nullptr} {}
 };
 
 template <typename T>
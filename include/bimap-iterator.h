@@ -66,38 +66,12 @@ public:
   }
 
   iterator& operator++() {
-    if (_node->right) {
-      _node = _node->right;
-      if (!is_end()) {
-        while (_node->left) {
-          _node = _node->left;
-        }
-      }
-    } else {
-      auto parent = _node->parent;
-      while (parent && _node == parent->right) {
-        _node = parent;
-        parent = _node->parent;
-      }
-      _node = parent;
-    }
+    _node = _node->next;
     return *this;
   }
 
   iterator& operator--() {
-    if (_node->left && !is_end()) {
-      _node = _node->left;
-      while (_node->right) {
-        _node = _node->right;
-      }
-    } else {
-      auto parent = _node->parent;
-      while (parent && _node == parent->left) {
-        _node = parent;
-        parent = _node->parent;
-      }
-      _node = parent;
-    }
+    _node = _node->prev;
     return *this;
   }
 
@@ -4,9 +4,13 @@
 #include "bimap-element.h"
 #include "bimap-iterator.h"
 
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <functional>
+#include <iterator>
 #include <utility>
+#include <vector>
 
 template <
     typename Left,
@@ -30,24 +34,109 @@ public:
   using left_iterator = typename left::iterator;
   using right_iterator = typename right::iterator;
 
+  // Owns a node detached from a bimap; its keys may be changed before it is inserted again.
+  // The processor keeps its seating in `client_index`, so node handles and `replace_right`/`replace_left`
+  // serve other callers that re-key pairs, such as pc_club_bimap_bench.
+  class node_type {
+  public:
+    node_type() = default;
+
+    node_type(node_type&& other) noexcept
+        : _node(std::exchange(other._node, nullptr)) {}
+
+    node_type& operator=(node_type&& other) noexcept {
+      if (this != &other) {
+        delete _node;
+        _node = std::exchange(other._node, nullptr);
+      }
+      return *this;
+    }
+
+    ~node_type() {
+      delete _node;
+    }
+
+    bool empty() const {
+      return _node == nullptr;
+    }
+
+    explicit operator bool() const {
+      return !empty();
+    }
+
+    left_t& left() const {
+      return static_cast<typename bimap::left::node_t*>(_node)->data;
+    }
+
+    right_t& right() const {
+      return static_cast<typename bimap::right::node_t*>(_node)->data;
+    }
+
+  private:
+    friend class bimap;
+
+    explicit node_type(node_t* node)
+        : _node(node) {}
+
+    node_t* _node{};
+  };
+
+  struct insert_return_type {
+    left_iterator position;
+    bool inserted;
+    node_type node;
+  };
+
   bimap(CompareLeft compare_left = CompareLeft(), CompareRight compare_right = CompareRight())
       : left(std::move(compare_left))
       , right(std::move(compare_right)) {
     init_base();
   }
 
+  // Builds both trees balanced in O(n) after sorting; input that is already ordered skips the sort.
+  // Entries are accepted as by successive `insert`, so duplicate keys keep the first occurrence.
+  template <std::input_iterator InputIt>
+  bimap(
+      InputIt first,
+      InputIt last,
+      CompareLeft compare_left = CompareLeft(),
+      CompareRight compare_right = CompareRight()
+  )
+      : left(std::move(compare_left))
+      , right(std::move(compare_right)) {
+    init_base();
+    std::vector<node_t*> nodes;
+    try {
+      for (; first != last; ++first) {
+        nodes.push_back(nullptr);
+        nodes.back() = new node_t(first->first, first->second);
+      }
+    } catch (...) {
+      for (node_t* node : nodes) {
+        delete node;
+      }
+      throw;
+    }
+    _assign_nodes(std::move(nodes));
+  }
+
   bimap(const bimap& other)
       : left(other)
       , right(other) {
     init_base();
+    std::vector<node_t*> nodes;
     try {
+      nodes.reserve(other._size);
       for (auto it = other.begin_left(); it != other.end_left(); ++it) {
-        insert(*it, *it.flip());
+        nodes.push_back(new node_t(*it, *it.flip()));
       }
     } catch (...) {
-      _free();
+      for (node_t* node : nodes) {
+        delete node;
+      }
       throw;
     }
+    _assign_nodes(std::move(nodes));
   }
 
   bimap(bimap&& other) noexcept
@@ -101,7 +190,112 @@ public:
     return _try_emplace(std::move(left), std::move(right));
   }
 
+  // On a key collision the node is handed back in `node` and `position` is `end_left()`.
+  insert_return_type insert(node_type&& node) {
+    if (node.empty()) {
+      return {end_left(), false, node_type()};
+    }
+    if (_link(node._node)) {
+      return {left_iterator(static_cast<typename left::node_t*>(std::exchange(node._node, nullptr))), true, node_type()};
+    }
+    return {end_left(), false, std::move(node)};
+  }
+
+  node_type extract_left(left_iterator it) {
+    right::erase(it.flip());
+    left::erase(it);
+    --_size;
+    node_t* node = static_cast<node_t*>(static_cast<typename left::node_t*>(it._node));
+    _unlink(node);
+    return node_type(node);
+  }
+
+  node_type extract_right(right_iterator it) {
+    return extract_left(it.flip());
+  }
+
+  node_type extract_left(const left_t& left) {
+    if (auto it = find_left(left); it != end_left()) {
+      return extract_left(it);
+    }
+    return node_type();
+  }
+
+  node_type extract_right(const right_t& right) {
+    if (auto it = find_right(right); it != end_right()) {
+      return extract_right(it);
+    }
+    return node_type();
+  }
+
+  // Rebinds the pair at `it` to a new right key, relinking only the right tree; the node is neither
+  // reallocated nor is its left key copied. Returns `end_left()` if the new key is taken by another pair.
+  // If copying the key throws, the pair keeps its old key; if moving it in throws, the pair is erased.
+  template <typename R = right_t>
+  left_iterator replace_right(left_iterator it, R&& right) {
+    auto current = it.flip();
+    if (!right::compare(*current, right) && !right::compare(right, *current)) {
+      return it;
+    }
+    if (find_right(right) != end_right()) {
+      return end_left();
+    }
+    // The key is built before the node leaves the tree, so a throwing copy leaves the pair untouched.
+    right_t key(std::forward<R>(right));
+    right::erase(current);
+    node_t* node = static_cast<node_t*>(static_cast<typename left::node_t*>(it._node));
+    auto& side = static_cast<typename right::node_t&>(*node);
+    try {
+      side.data = std::move(key);
+    } catch (...) {
+      // The old key may be gone as well, so the pair is dropped rather than relinked.
+      left::erase(it);
+      delete node;
+      --_size;
+      throw;
+    }
+    side.left = side.right = side.parent = nullptr;
+    right::emplace_hint(lower_bound_right(side.data), node);
+    return it;
+  }
+
+  // Mirror of `replace_right`: relinks only the left tree.
+  template <typename L = left_t>
+  right_iterator replace_left(right_iterator it, L&& left) {
+    auto current = it.flip();
+    if (!left::compare(*current, left) && !left::compare(left, *current)) {
+      return it;
+    }
+    if (find_left(left) != end_left()) {
+      return end_right();
+    }
+    // The key is built before the node leaves the tree, so a throwing copy leaves the pair untouched.
+    left_t key(std::forward<L>(left));
+    left::erase(current);
+    node_t* node = static_cast<node_t*>(static_cast<typename right::node_t*>(it._node));
+    auto& side = static_cast<typename left::node_t&>(*node);
+    try {
+      side.data = std::move(key);
+    } catch (...) {
+      // The old key may be gone as well, so the pair is dropped rather than relinked.
+      right::erase(it);
+      delete node;
+      --_size;
+      throw;
+    }
+    side.left = side.right = side.parent = nullptr;
+    left::emplace_hint(lower_bound_left(side.data), node);
+    return it;
+  }
+
 private:
+  static void _unlink(node_t* node) noexcept {
+    auto& l = static_cast<typename left::node_t&>(*node);
+    auto& r = static_cast<typename right::node_t&>(*node);
+    l.left = l.right = l.parent = l.prev = l.next = nullptr;
+    r.left = r.right = r.parent = r.prev = r.next = nullptr;
+  }
+
   template <typename L, typename R>
   left_iterator _try_emplace(L&& left, R&& right) {
     if (auto lit = lower_bound_left(left); lit == end_left() || left::compare(left, *lit)) {
@@ -115,17 +309,114 @@ private:
     return end_left();
   }
 
+  static const left_t& _left_of(node_t* node) {
+    return static_cast<typename left::node_t*>(node)->data;
+  }
+
+  static const right_t& _right_of(node_t* node) {
+    return static_cast<typename right::node_t*>(node)->data;
+  }
+
+  // Takes ownership of `nodes` (in any order) and links them into both trees.
+  void _assign_nodes(std::vector<node_t*> nodes) {
+    auto by_left = [this](node_t* a, node_t* b) { return left::compare(_left_of(a), _left_of(b)); };
+    auto by_right = [this](node_t* a, node_t* b) { return right::compare(_right_of(a), _right_of(b)); };
+    std::vector<node_t*> left_order, right_order;
+    try {
+      left_order = nodes;
+      right_order = nodes;
+    } catch (...) {
+      for (node_t* node : nodes) {
+        delete node;
+      }
+      throw;
+    }
+    if (!std::is_sorted(left_order.begin(), left_order.end(), by_left)) {
+      std::stable_sort(left_order.begin(), left_order.end(), by_left);
+    }
+    if (!std::is_sorted(right_order.begin(), right_order.end(), by_right)) {
+      std::stable_sort(right_order.begin(), right_order.end(), by_right);
+    }
+    auto not_less = [](auto cmp) {
+      return [cmp](node_t* a, node_t* b) { return !cmp(a, b); };
+    };
+    if (std::adjacent_find(left_order.begin(), left_order.end(), not_less(by_left)) != left_order.end()
+        || std::adjacent_find(right_order.begin(), right_order.end(), not_less(by_right)) != right_order.end()) {
+      // Which duplicate survives depends on the input order, so replay it.
+      for (node_t* node : nodes) {
+        if (!_link(node)) {
+          delete node;
+        }
+      }
+      return;
+    }
+    left::assign_sorted(left_order.data(), left_order.size());
+    right::assign_sorted(right_order.data(), right_order.size());
+    _size = nodes.size();
+  }
+
+  bool _rebuild_pays_off(std::size_t erased) const noexcept {
+    return erased * static_cast<std::size_t>(std::bit_width(_size)) >= _size;
+  }
+
+  // Deletes the nodes for which `erased` holds and links the rest into balanced trees. Both trees are
+  // walked in order, so the kept nodes need no sorting; nothing changes if the buffers cannot be allocated.
+  template <typename Erased>
+  void _rebuild_without(Erased erased) {
+    std::vector<node_t*> left_order, right_order, dropped;
+    left_order.reserve(_size);
+    right_order.reserve(_size);
+    dropped.reserve(_size);
+    for (auto it = begin_left(); it != end_left(); ++it) {
+      node_t* node = static_cast<node_t*>(static_cast<typename left::node_t*>(it._node));
+      (erased(node) ? dropped : left_order).push_back(node);
+    }
+    for (auto it = begin_right(); it != end_right(); ++it) {
+      node_t* node = static_cast<node_t*>(static_cast<typename right::node_t*>(it._node));
+      if (!erased(node)) {
+        right_order.push_back(node);
+      }
+    }
+    left::assign_sorted(left_order.data(), left_order.size());
+    right::assign_sorted(right_order.data(), right_order.size());
+    _size = left_order.size();
+    for (node_t* node : dropped) {
+      delete node;
+    }
+  }
+
+  bool _link(node_t* node) noexcept {
+    if (auto lit = lower_bound_left(_left_of(node)); lit == end_left() || left::compare(_left_of(node), *lit)) {
+      if (auto rit = lower_bound_right(_right_of(node)); rit == end_right() || right::compare(_right_of(node), *rit)) {
+        ++_size;
+        right::emplace_hint(rit, node);
+        left::emplace_hint(lit, node);
+        return true;
+      }
+    }
+    return false;
+  }
+
   void _free() noexcept {
     auto rs = &static_cast<typename right::node_no_data_t&>(_sentinel);
     rs->parent->right = nullptr;
     _free(rs->right);
   }
 
+  // Post-order walk over the right tree without recursion, so degenerate trees cannot overflow the stack.
   static void _free(bimap_impl::node_base* node) noexcept {
-    if (node) {
-      _free(node->left);
-      _free(node->right);
-      delete static_cast<node_t*>(static_cast<typename right::node_t*>(node));
+    while (node) {
+      if (auto child = node->left) {
+        node->left = nullptr;
+        node = child;
+      } else if (auto child = node->right) {
+        node->right = nullptr;
+        node = child;
+      } else {
+        auto parent = node->parent;
+        delete static_cast<node_t*>(static_cast<typename right::node_t*>(node));
+        node = parent;
+      }
     }
   }
 
@@ -178,20 +469,53 @@ public:
     return false;
   }
 
+  // A range that is a large share of the map is erased by relinking the kept nodes in O(n) rather than
+  // unlinking the range node by node in O(k log n).
   left_iterator erase_left(left_iterator first, left_iterator last) {
-    do {
+    if (first == begin_left() && last == end_left()) {
+      clear();
+      return end_left();
+    }
+    if (_rebuild_pays_off(static_cast<std::size_t>(std::distance(first, last)))) {
+      const left_t& from = *first;
+      const left_t* to = last == end_left() ? nullptr : &*last;
+      _rebuild_without([&](node_t* node) {
+        return !left::compare(_left_of(node), from) && (!to || left::compare(_left_of(node), *to));
+      });
+      return last;
+    }
+    while (first != last) {
       first = erase_left(first);
-    } while (last != first);
+    }
     return first;
   }
 
   right_iterator erase_right(right_iterator first, right_iterator last) {
-    do {
+    if (first == begin_right() && last == end_right()) {
+      clear();
+      return end_right();
+    }
+    if (_rebuild_pays_off(static_cast<std::size_t>(std::distance(first, last)))) {
+      const right_t& from = *first;
+      const right_t* to = last == end_right() ? nullptr : &*last;
+      _rebuild_without([&](node_t* node) {
+        return !right::compare(_right_of(node), from) && (!to || right::compare(_right_of(node), *to));
+      });
+      return last;
+    }
+    while (first != last) {
       first = erase_right(first);
-    } while (last != first);
+    }
     return first;
   }
 
+  void clear() noexcept {
+    _free();
+    left::reset();
+    right::reset();
+    _size = 0;
+  }
+
   left_iterator find_left(const left_t& left) const {
     return left::find(left);
   }
@@ -283,6 +607,27 @@ public:
     return _size;
   }
 
+  // Shape and footprint, for spotting degenerate trees and memory growth.
+  struct stats_type {
+    bimap_impl::tree_stats left;
+    bimap_impl::tree_stats right;
+    std::size_t nodes;
+    // A node holds both keys and the links of both trees; memory owned by the keys themselves is not counted.
+    std::size_t node_bytes;
+    // The nodes and the bimap object.
+    std::size_t total_bytes;
+  };
+
+  stats_type stats() const {
+    return {
+        .left = left::shape(),
+        .right = right::shape(),
+        .nodes = _size,
+        .node_bytes = sizeof(node_t),
+        .total_bytes = _size * sizeof(node_t) + sizeof(bimap)
+    };
+  }
+
   friend bool operator==(const bimap& lhs, const bimap& rhs) {
     if (&lhs == &rhs) {
       return true;
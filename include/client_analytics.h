@@ -0,0 +1,74 @@
+#pragma once
+#ifndef __client_analytics_h_
+#define __client_analytics_h_
+
+#include "flat_hash_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pc_club {
+struct client_stats {
+  std::int64_t spend = 0;
+  // Minutes at a table.
+  std::int64_t seat_time = 0;
+  // Times the client joined the queue.
+  std::int32_t waits = 0;
+  // Times the client left because the queue was full.
+  std::int32_t turn_aways = 0;
+
+  client_stats& operator+=(const client_stats& other) {
+    spend += other.spend;
+    seat_time += other.seat_time;
+    waits += other.waits;
+    turn_aways += other.turn_aways;
+    return *this;
+  }
+};
+
+// Per-client aggregates in a `swiss_table`, each stored with its name's hash. Aggregates of different
+// days or files are combined with `merge`, so they can be collected in parallel and rolled up afterwards;
+// the stored hashes come along, so merging does not hash the names again.
+class client_analytics {
+public:
+  client_stats& operator[](std::string_view name);
+  // nullptr if the client has not been seen.
+  const client_stats* find(std::string_view name) const;
+
+  void record_session(std::string_view name, std::int32_t duration, std::int64_t cost);
+  void record_wait(std::string_view name);
+  void record_turn_away(std::string_view name);
+
+  void merge(const client_analytics& other);
+
+  // The `k` biggest spenders, best first; ties are broken by name.
+  std::vector<std::pair<std::string_view, client_stats>> top_spenders(std::size_t k) const;
+
+  std::size_t size() const {
+    return _table.size();
+  }
+
+private:
+  struct slot {
+    std::string name;
+    client_stats stats;
+    std::size_t hash = 0;
+  };
+
+  static std::size_t hash_of(const slot& s) {
+    return s.hash;
+  }
+
+  std::size_t _find(std::string_view name, std::size_t hash) const;
+  // The client's aggregates, added empty if the name is new.
+  client_stats& _stats(std::string_view name, std::size_t hash);
+
+  swiss_table<slot> _table;
+};
+} // namespace pc_club
+
+#endif // !__client_analytics_h_
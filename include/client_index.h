@@ -0,0 +1,192 @@
+#pragma once
+#ifndef __client_index_h_
+#define __client_index_h_
+
+#include "flat_hash_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pc_club {
+// Everything the processor knows about one client, on one cache line.
+struct alignas(64) client_record {
+  std::string name;
+  std::size_t hash = 0;
+  // 0 when not seated.
+  std::int32_t table = 0;
+  std::int32_t seated_since = 0;
+  // Entries of the client in the queue: a client may queue more than once, and stays queued after leaving.
+  std::uint32_t queued = 0;
+  bool present = false;
+};
+
+static_assert(sizeof(client_record) == 64);
+
+// The clients of a club with one record each, indexed by name (a `swiss_table` of record ids), by
+// table and by queue order, in the spirit of a multi-index container specialized for the processor.
+// Records are addressed by id, which stays valid until the record is released; released records keep
+// their name storage for later clients, so a warmed-up index does not allocate.
+class client_index {
+public:
+  using id = std::uint32_t;
+  static constexpr id none = static_cast<id>(-1);
+
+  explicit client_index(std::int32_t tables);
+
+  client_record& operator[](id client) {
+    return _records[client];
+  }
+
+  const client_record& operator[](id client) const {
+    return _records[client];
+  }
+
+  // By name: `none` if the client has no record.
+  id find(std::string_view name, std::size_t hash) const;
+  // The client's record, created absent, unseated and unqueued if there is none.
+  id find_or_insert(std::string_view name, std::size_t hash);
+
+  void set_present(id client, bool present);
+
+  // By table: `none` if the table is free.
+  id at_table(std::int32_t table_id) const {
+    return _by_table[static_cast<std::size_t>(table_id)];
+  }
+
+  std::int32_t seated() const {
+    return _seated;
+  }
+
+  // Returns false, changing nothing, if the client already has a table; `table_id` must be free.
+  bool seat(id client, std::int32_t table_id, std::int32_t time);
+  void unseat(std::int32_t table_id);
+
+  // By queue order; the queue holds at most as many entries as there are tables.
+  std::size_t queued() const {
+    return _queue_size;
+  }
+
+  bool queue_full() const {
+    return _queue_size == _queue.size();
+  }
+
+  void enqueue(id client);
+  // The front of the queue, or `none` if it is empty.
+  id dequeue();
+
+  template <typename F>
+  void for_each_queued(F&& f) const {
+    for (std::size_t i = 0; i < _queue_size; i++) {
+      f(_records[_queue[(_queue_head + i) % _queue.size()]]);
+    }
+  }
+
+  // Drops the client's record if the client is neither present, seated nor queued.
+  void release(id client);
+
+  std::size_t size() const {
+    return _by_name.size();
+  }
+
+  template <typename F>
+  void for_each(F&& f) const {
+    _by_name.for_each([&](id client) { f(_records[client]); });
+  }
+
+  // While journaling, every change is logged so that `undo` can take it back, and released records
+  // are not handed out again, so their names stay available to it.
+  void set_journaling(bool journaling) {
+    _journaling = journaling;
+  }
+
+  // Position in the journal to undo back to.
+  std::size_t journal_size() const {
+    return _journal.size();
+  }
+
+  // Takes back every change logged after `mark`, newest first.
+  void undo(std::size_t mark);
+  // Forgets the journal: changes so far can no longer be undone.
+  void commit() {
+    _journal.clear();
+  }
+
+  // Releases every record, keeping the storage, and forgets the journal.
+  void clear();
+  // After `clear`: gives back storage held for more than twice `expected` clients.
+  void compact(std::size_t expected);
+
+  void prefetch(std::size_t hash) const {
+    _by_name.prefetch(hash);
+  }
+
+  // Heap bytes by part, counted by capacity: released records and their names are included.
+  struct memory_usage {
+    std::size_t records;
+    // Names too long to be stored inside their record.
+    std::size_t names;
+    std::size_t name_index;
+    std::size_t table_index;
+    std::size_t queue;
+  };
+
+  memory_usage memory() const;
+
+private:
+  struct change {
+    enum class kind : std::uint8_t {
+      // A record's fields changed.
+      record,
+      // A record was created, from a released id or at the end.
+      reused,
+      appended,
+      // A record left the name index.
+      released,
+      // The queue moved.
+      queue
+    };
+
+    kind what;
+    id client;
+    // `record`: the fields before the change.
+    std::int32_t table = 0;
+    std::int32_t seated_since = 0;
+    std::uint32_t queued = 0;
+    bool present = false;
+    // `queue`: the ring before the change, with the slot an enqueue would overwrite.
+    std::size_t queue_head = 0;
+    std::size_t queue_size = 0;
+    id slot = none;
+  };
+
+  std::size_t _hash_of(id client) const {
+    return _records[client].hash;
+  }
+
+  std::size_t _slot_of(id client) const {
+    return _by_name.find(_records[client].hash, [client](id c) { return c == client; });
+  }
+
+  void _log(change::kind what, id client);
+  void _log_record(id client);
+  void _log_queue();
+
+  std::vector<client_record> _records;
+  std::vector<id> _free;
+  swiss_table<id> _by_name;
+  // Indexed by table id, 1..n.
+  std::vector<id> _by_table;
+  std::int32_t _seated = 0;
+  // Ring buffer sized to the table count.
+  std::vector<id> _queue;
+  std::size_t _queue_head = 0;
+  std::size_t _queue_size = 0;
+  bool _journaling = false;
+  std::vector<change> _journal;
+};
+} // namespace pc_club
+
+#endif // !__client_index_h_
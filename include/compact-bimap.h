@@ -0,0 +1,573 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#define MY_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define MY_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+template <typename, typename, typename, typename>
+class compact_bimap;
+
+namespace bimap_impl {
+using index_t = std::uint32_t;
+
+inline constexpr index_t null_index = std::numeric_limits<index_t>::max();
+
+// Slot 0 of the node vector is the sentinel: its `next` is the first node of a side and `prev` the last.
+struct compact_links {
+  index_t left{null_index}, right{null_index}, parent{null_index};
+  index_t prev{0}, next{0};
+};
+
+// Refers to a node by (map, index), so it stays valid when the node vector reallocates.
+template <typename Map, std::size_t Side>
+class compact_iterator {
+  template <typename, std::size_t>
+  friend class compact_iterator;
+
+  template <typename, typename, typename, typename>
+  friend class ::compact_bimap;
+
+  compact_iterator(const Map* map, index_t index)
+      : _map(map)
+      , _index(index) {}
+
+public:
+  using value_type = std::conditional_t<Side == 0, typename Map::left_t, typename Map::right_t>;
+
+  using reference = const value_type&;
+  using const_reference = const value_type&;
+
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type*;
+
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  compact_iterator() = default;
+
+  const_reference operator*() const {
+    return _map->template _key<Side>(_index);
+  }
+
+  pointer operator->() const {
+    return &_map->template _key<Side>(_index);
+  }
+
+  compact_iterator& operator++() {
+    _index = _map->_nodes[_index].links[Side].next;
+    return *this;
+  }
+
+  compact_iterator& operator--() {
+    _index = _map->_nodes[_index].links[Side].prev;
+    return *this;
+  }
+
+  compact_iterator operator++(int) {
+    compact_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  compact_iterator operator--(int) {
+    compact_iterator tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  compact_iterator<Map, 1 - Side> flip() const {
+    return compact_iterator<Map, 1 - Side>(_map, _index);
+  }
+
+  friend bool operator==(const compact_iterator& lhs, const compact_iterator& rhs) {
+    return lhs._index == rhs._index && lhs._map == rhs._map;
+  }
+
+  friend bool operator!=(const compact_iterator& lhs, const compact_iterator& rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  const Map* _map{};
+  index_t _index{};
+};
+} // namespace bimap_impl
+
+// Same interface as `bimap`, but all nodes live in one vector and link to each other with 32-bit indices.
+// Erased slots are recycled through a free list and keep their pair, so a reused slot is assigned
+// to (keeping e.g. string capacity) rather than reconstructed; `reserve` makes inserts allocation-free.
+// A standalone container: the processor keeps its seating in `client_index` and does not select it.
+template <
+    typename Left,
+    typename Right,
+    typename CompareLeft = std::less<Left>,
+    typename CompareRight = std::less<Right>>
+class compact_bimap {
+public:
+  using left_t = Left;
+  using right_t = Right;
+
+  using left_iterator = bimap_impl::compact_iterator<compact_bimap, 0>;
+  using right_iterator = bimap_impl::compact_iterator<compact_bimap, 1>;
+
+private:
+  template <typename, std::size_t>
+  friend class bimap_impl::compact_iterator;
+
+  using index_t = bimap_impl::index_t;
+  static constexpr index_t null_index = bimap_impl::null_index;
+
+  struct node_t {
+    bimap_impl::compact_links links[2];
+    std::optional<std::pair<Left, Right>> value;
+  };
+
+public:
+  compact_bimap(CompareLeft compare_left = CompareLeft(), CompareRight compare_right = CompareRight())
+      : _compare_left(std::move(compare_left))
+      , _compare_right(std::move(compare_right)) {}
+
+  compact_bimap(const compact_bimap& other) = default;
+
+  compact_bimap(compact_bimap&& other) noexcept
+      : _nodes(std::move(other._nodes))
+      , _root{std::exchange(other._root[0], null_index), std::exchange(other._root[1], null_index)}
+      , _free(std::exchange(other._free, null_index))
+      , _size(std::exchange(other._size, 0))
+      , _compare_left(std::move(other._compare_left))
+      , _compare_right(std::move(other._compare_right)) {
+    other._nodes.clear();
+  }
+
+  compact_bimap& operator=(const compact_bimap& other) {
+    if (this != &other) {
+      compact_bimap copy(other);
+      swap(*this, copy);
+    }
+    return *this;
+  }
+
+  compact_bimap& operator=(compact_bimap&& other) noexcept {
+    if (this != &other) {
+      compact_bimap moved(std::move(other));
+      swap(*this, moved);
+    }
+    return *this;
+  }
+
+  ~compact_bimap() = default;
+
+  friend void swap(compact_bimap& lhs, compact_bimap& rhs) noexcept {
+    using std::swap;
+    swap(lhs._nodes, rhs._nodes);
+    swap(lhs._root, rhs._root);
+    swap(lhs._free, rhs._free);
+    swap(lhs._size, rhs._size);
+    swap(lhs._compare_left, rhs._compare_left);
+    swap(lhs._compare_right, rhs._compare_right);
+  }
+
+  void reserve(std::size_t count) {
+    _nodes.reserve(count + 1);
+  }
+
+  template <typename L, typename R>
+  left_iterator insert(L&& left, R&& right) {
+    auto left_slot = _slot<0>(left), right_slot = _slot<1>(right);
+    if (!left_slot || !right_slot) {
+      return end_left();
+    }
+    index_t node = _allocate(std::forward<L>(left), std::forward<R>(right));
+    _link<0>(node, *left_slot);
+    _link<1>(node, *right_slot);
+    ++_size;
+    return left_iterator(this, node);
+  }
+
+  left_iterator erase_left(left_iterator it) {
+    auto next = std::next(it);
+    _erase(it._index);
+    return next;
+  }
+
+  right_iterator erase_right(right_iterator it) {
+    auto next = std::next(it);
+    _erase(it._index);
+    return next;
+  }
+
+  bool erase_left(const left_t& left) {
+    if (auto it = find_left(left); it != end_left()) {
+      erase_left(it);
+      return true;
+    }
+    return false;
+  }
+
+  bool erase_right(const right_t& right) {
+    if (auto it = find_right(right); it != end_right()) {
+      erase_right(it);
+      return true;
+    }
+    return false;
+  }
+
+  left_iterator erase_left(left_iterator first, left_iterator last) {
+    while (first != last) {
+      first = erase_left(first);
+    }
+    return first;
+  }
+
+  right_iterator erase_right(right_iterator first, right_iterator last) {
+    while (first != last) {
+      first = erase_right(first);
+    }
+    return first;
+  }
+
+  // Keeps the nodes with their pairs on the free list, so refilling up to the previous size does not
+  // allocate, and keys that own memory (e.g. strings) are assigned into their old capacity.
+  void clear() noexcept {
+    _free = null_index;
+    for (auto node = static_cast<index_t>(_nodes.size()); node-- > 1;) {
+      _nodes[node].links[0].next = _free;
+      _free = node;
+    }
+    if (!_nodes.empty()) {
+      _nodes[0].links[0] = _nodes[0].links[1] = bimap_impl::compact_links{};
+    }
+    _root[0] = _root[1] = null_index;
+    _size = 0;
+  }
+
+  // Rebinds the pair at `it` to a new right key, relinking only the right tree.
+  // Returns `end_left()` if the new key is taken by another pair. If copying the key throws, the pair
+  // keeps its old key; if moving it in throws, the pair is erased.
+  template <typename R = right_t>
+  left_iterator replace_right(left_iterator it, R&& right) {
+    return _replace<1>(it, std::forward<R>(right), end_left());
+  }
+
+  template <typename L = left_t>
+  right_iterator replace_left(right_iterator it, L&& left) {
+    return _replace<0>(it, std::forward<L>(left), end_right());
+  }
+
+  left_iterator find_left(const left_t& left) const {
+    return left_iterator(this, _find<0>(left));
+  }
+
+  right_iterator find_right(const right_t& right) const {
+    return right_iterator(this, _find<1>(right));
+  }
+
+  const right_t& at_left(const left_t& key) const {
+    if (auto it = find_left(key); it != end_left()) {
+      return *it.flip();
+    }
+    throw std::out_of_range("compact_bimap::at");
+  }
+
+  const left_t& at_right(const right_t& key) const {
+    if (auto it = find_right(key); it != end_right()) {
+      return *it.flip();
+    }
+    throw std::out_of_range("compact_bimap::at");
+  }
+
+  left_iterator lower_bound_left(const left_t& left) const {
+    return left_iterator(this, _lower_bound<0>(left, false));
+  }
+
+  left_iterator upper_bound_left(const left_t& left) const {
+    return left_iterator(this, _lower_bound<0>(left, true));
+  }
+
+  right_iterator lower_bound_right(const right_t& right) const {
+    return right_iterator(this, _lower_bound<1>(right, false));
+  }
+
+  right_iterator upper_bound_right(const right_t& right) const {
+    return right_iterator(this, _lower_bound<1>(right, true));
+  }
+
+  left_iterator begin_left() const {
+    return left_iterator(this, _nodes.empty() ? 0 : _nodes[0].links[0].next);
+  }
+
+  left_iterator end_left() const {
+    return left_iterator(this, 0);
+  }
+
+  right_iterator begin_right() const {
+    return right_iterator(this, _nodes.empty() ? 0 : _nodes[0].links[1].next);
+  }
+
+  right_iterator end_right() const {
+    return right_iterator(this, 0);
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  // Footprint, comparable with `bimap::stats`.
+  struct stats_type {
+    std::size_t nodes;
+    // A node holds both keys and the index links of both trees; memory owned by the keys is not counted.
+    std::size_t node_bytes;
+    // The node vector, including free slots and the sentinel, and the bimap object.
+    std::size_t total_bytes;
+  };
+
+  stats_type stats() const {
+    return {
+        .nodes = _size,
+        .node_bytes = sizeof(node_t),
+        .total_bytes = _nodes.capacity() * sizeof(node_t) + sizeof(compact_bimap)
+    };
+  }
+
+  friend bool operator==(const compact_bimap& lhs, const compact_bimap& rhs) {
+    if (lhs._size != rhs._size) {
+      return false;
+    }
+    for (auto lhs_it = lhs.begin_left(), rhs_it = rhs.begin_left(); lhs_it != lhs.end_left(); ++lhs_it, ++rhs_it) {
+      if (lhs._less<0>(*lhs_it, *rhs_it) || lhs._less<0>(*rhs_it, *lhs_it)
+          || lhs._less<1>(*lhs_it.flip(), *rhs_it.flip()) || lhs._less<1>(*rhs_it.flip(), *lhs_it.flip())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend bool operator!=(const compact_bimap& lhs, const compact_bimap& rhs) {
+    return !operator==(lhs, rhs);
+  }
+
+private:
+  template <std::size_t Side>
+  using key_t = std::conditional_t<Side == 0, Left, Right>;
+
+  struct slot_t {
+    index_t parent;
+    bool as_left;
+  };
+
+  template <std::size_t Side>
+  const key_t<Side>& _key(index_t node) const {
+    if constexpr (Side == 0) {
+      return _nodes[node].value->first;
+    } else {
+      return _nodes[node].value->second;
+    }
+  }
+
+  template <std::size_t Side>
+  bool _less(const key_t<Side>& lhs, const key_t<Side>& rhs) const {
+    if constexpr (Side == 0) {
+      return _compare_left(lhs, rhs);
+    } else {
+      return _compare_right(lhs, rhs);
+    }
+  }
+
+  template <std::size_t Side>
+  bimap_impl::compact_links& _links(index_t node) {
+    return _nodes[node].links[Side];
+  }
+
+  template <std::size_t Side>
+  index_t _lower_bound(const key_t<Side>& value, bool strict) const {
+    index_t current = _root[Side], bound = 0;
+    while (current != null_index) {
+      const auto& data = _key<Side>(current);
+      if (strict ? _less<Side>(value, data) : !_less<Side>(data, value)) {
+        bound = current;
+        current = _nodes[current].links[Side].left;
+      } else {
+        current = _nodes[current].links[Side].right;
+      }
+    }
+    return bound;
+  }
+
+  template <std::size_t Side>
+  index_t _find(const key_t<Side>& value) const {
+    index_t it = _lower_bound<Side>(value, false);
+    return it == 0 || _less<Side>(value, _key<Side>(it)) ? 0 : it;
+  }
+
+  // Where a new key would be attached, or nothing if it is already present.
+  template <std::size_t Side>
+  std::optional<slot_t> _slot(const key_t<Side>& value) const {
+    slot_t slot{.parent = null_index, .as_left = false};
+    index_t current = _root[Side];
+    while (current != null_index) {
+      const auto& data = _key<Side>(current);
+      slot.parent = current;
+      if (_less<Side>(value, data)) {
+        slot.as_left = true;
+        current = _nodes[current].links[Side].left;
+      } else if (_less<Side>(data, value)) {
+        slot.as_left = false;
+        current = _nodes[current].links[Side].right;
+      } else {
+        return std::nullopt;
+      }
+    }
+    return slot;
+  }
+
+  template <typename L, typename R>
+  index_t _allocate(L&& left, R&& right) {
+    if (_nodes.empty()) {
+      _nodes.emplace_back();
+    }
+    if (_free != null_index) {
+      index_t node = _free;
+      auto& value = _nodes[node].value;
+      if constexpr (std::is_assignable_v<Left&, L&&> && std::is_assignable_v<Right&, R&&>) {
+        value->first = std::forward<L>(left);
+        value->second = std::forward<R>(right);
+      } else {
+        value.emplace(std::forward<L>(left), std::forward<R>(right));
+      }
+      _free = _nodes[node].links[0].next;
+      return node;
+    }
+    if (_nodes.size() > null_index - 1) {
+      throw std::length_error("compact_bimap");
+    }
+    _nodes.emplace_back().value.emplace(std::forward<L>(left), std::forward<R>(right));
+    return static_cast<index_t>(_nodes.size() - 1);
+  }
+
+  template <std::size_t Side>
+  void _link(index_t node, slot_t slot) {
+    auto& links = _links<Side>(node);
+    links.left = links.right = null_index;
+    links.parent = slot.parent;
+    index_t prev, next;
+    if (slot.parent == null_index) {
+      _root[Side] = node;
+      prev = next = 0;
+    } else if (slot.as_left) {
+      _links<Side>(slot.parent).left = node;
+      prev = _links<Side>(slot.parent).prev;
+      next = slot.parent;
+    } else {
+      _links<Side>(slot.parent).right = node;
+      prev = slot.parent;
+      next = _links<Side>(slot.parent).next;
+    }
+    links.prev = prev;
+    links.next = next;
+    _links<Side>(prev).next = node;
+    _links<Side>(next).prev = node;
+  }
+
+  template <std::size_t Side>
+  void _transplant(index_t from, index_t to) {
+    index_t parent = _links<Side>(from).parent;
+    if (parent == null_index) {
+      _root[Side] = to;
+    } else if (_links<Side>(parent).left == from) {
+      _links<Side>(parent).left = to;
+    } else {
+      _links<Side>(parent).right = to;
+    }
+    if (to != null_index) {
+      _links<Side>(to).parent = parent;
+    }
+  }
+
+  template <std::size_t Side>
+  void _unlink(index_t node) {
+    auto& links = _links<Side>(node);
+    _links<Side>(links.prev).next = links.next;
+    _links<Side>(links.next).prev = links.prev;
+    if (links.left == null_index) {
+      _transplant<Side>(node, links.right);
+    } else if (links.right == null_index) {
+      _transplant<Side>(node, links.left);
+    } else {
+      // Both children: the in-order successor is the minimum of the right subtree.
+      index_t successor = links.next;
+      if (_links<Side>(successor).parent != node) {
+        _transplant<Side>(successor, _links<Side>(successor).right);
+        _links<Side>(successor).right = links.right;
+        _links<Side>(links.right).parent = successor;
+      }
+      _transplant<Side>(node, successor);
+      _links<Side>(successor).left = links.left;
+      _links<Side>(links.left).parent = successor;
+    }
+  }
+
+  void _erase(index_t node) {
+    _unlink<0>(node);
+    _unlink<1>(node);
+    _nodes[node].links[0].next = _free;
+    _free = node;
+    --_size;
+  }
+
+  template <std::size_t Side, typename Iterator, typename Key, typename Result>
+  Result _replace(Iterator it, Key&& value, Result failure) {
+    index_t node = it._index;
+    const auto& current = _key<Side>(node);
+    if (!_less<Side>(current, value) && !_less<Side>(value, current)) {
+      return Result(this, node);
+    }
+    if (_find<Side>(value) != 0) {
+      return failure;
+    }
+    // Built before the node is unlinked, so a throwing copy leaves the pair untouched.
+    key_t<Side> key(std::forward<Key>(value));
+    _unlink<Side>(node);
+    try {
+      if constexpr (Side == 0) {
+        _nodes[node].value->first = std::move(key);
+      } else {
+        _nodes[node].value->second = std::move(key);
+      }
+    } catch (...) {
+      // The old key may be gone as well, so the pair is dropped rather than relinked.
+      _unlink<1 - Side>(node);
+      _nodes[node].links[0].next = _free;
+      _free = node;
+      --_size;
+      throw;
+    }
+    _link<Side>(node, *_slot<Side>(_key<Side>(node)));
+    return Result(this, node);
+  }
+
+private:
+  std::vector<node_t> _nodes;
+  index_t _root[2]{null_index, null_index};
+  index_t _free{null_index};
+  std::size_t _size{};
+  MY_NO_UNIQUE_ADDRESS CompareLeft _compare_left;
+  MY_NO_UNIQUE_ADDRESS CompareRight _compare_right;
+};
+
+#undef MY_NO_UNIQUE_ADDRESS
@@ -0,0 +1,31 @@
+#pragma once
+#ifndef __event_parser_h_
+#define __event_parser_h_
+
+#include "event_processor.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace pc_club {
+struct club_parameters {
+  std::int32_t tables;
+  std::int32_t price;
+  std::int32_t open_time;
+  std::int32_t close_time;
+};
+
+// "HH:MM" to minutes since midnight, or -1 if malformed.
+std::int32_t parse_time(std::string_view str);
+
+// Parses one event line of a club with `tables` tables; returns false if the line is malformed.
+// Retractions (id 5) are only accepted with `corrections`, as in the `--corrections` mode.
+bool parse_event(std::string_view line, std::int32_t tables, event& e, bool corrections = false);
+
+// Header lines, in input order.
+bool parse_tables(std::string_view line, std::int32_t& tables);
+bool parse_hours(std::string_view line, std::int32_t& open_time, std::int32_t& close_time);
+bool parse_price(std::string_view line, std::int32_t& price);
+} // namespace pc_club
+
+#endif // !__event_parser_h_
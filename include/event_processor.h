@@ -2,13 +2,23 @@
 #ifndef __event_processor_h_
 #define __event_processor_h_
 
-#include "bimap.h"
-
-#include <queue>
+#include "client_analytics.h"
+#include "client_index.h"
+#include "flat_hash_set.h"
+#include "occupancy_heatmap.h"
+#include "output_encoder.h"
+#include "seating_snapshot.h"
 
+#include <array>
 #include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace pc_club {
@@ -16,7 +26,9 @@ enum class event_type : std::int8_t {
   enter = 1,
   take = 2,
   wait = 3,
-  leave = 4
+  leave = 4,
+  // Takes back the client's event at `target_time`; see `basic_event_processor::set_journal`.
+  retract = 5
 };
 
 struct event {
@@ -24,42 +36,332 @@ struct event {
   event_type type;
   std::string name;
   std::int32_t table;
+  // For `retract`: the time of the event taken back.
+  std::int32_t target_time = -1;
+  // `hash_name(name)`, filled in by the parser; 0 means not computed, and the processor hashes the name itself.
+  std::size_t name_hash = 0;
 };
 
 struct table {
-  std::int32_t occupied_since;
-  std::int64_t revenue;
-  std::int32_t usage;
+  std::int64_t revenue = 0;
+  std::int32_t usage = 0;
+
+  bool operator==(const table&) const = default;
+};
+
+// Club-wide results of a processed day.
+struct day_totals {
+  std::int64_t revenue = 0;
+  // Table minutes.
+  std::int64_t usage = 0;
+  std::int32_t turn_aways = 0;
+  std::int32_t errors = 0;
 };
 
-class event_processor {
+// Bytes a processor holds, by container; heap storage is counted by capacity, so room kept for reuse
+// shows too. See `client_index::memory_usage` for the client parts.
+struct processor_memory {
+  std::size_t client_records = 0;
+  std::size_t client_names = 0;
+  std::size_t name_index = 0;
+  std::size_t table_index = 0;
+  std::size_t queue = 0;
+  std::size_t tables = 0;
+  std::size_t output_buffer = 0;
+
+  std::size_t total() const {
+    return client_records + client_names + name_index + table_index + queue + tables + output_buffer;
+  }
+};
+
+// Everything a processor knows between two events, independent of its layout; see
+// `basic_event_processor::snapshot`.
+struct processor_state {
+  // Tables 1..n at index 0..n-1.
+  std::vector<table> tables;
+  // Clients inside the club, in no particular order.
+  std::vector<std::string> clients;
+  // The queue, front first.
+  std::vector<std::string> waiting;
+  struct seat {
+    std::string name;
+    std::int32_t table;
+    std::int32_t since;
+
+    bool operator==(const seat&) const = default;
+  };
+  std::vector<seat> seated;
+  std::int32_t turn_aways = 0;
+  std::int32_t errors = 0;
+};
+
+// Every started hour is paid in full.
+constexpr std::int64_t billed_hours(std::int32_t duration) {
+  return (duration + 59) / 60;
+}
+
+// Table state sized and priced at run time.
+class dynamic_layout {
 public:
-  event_processor(std::int32_t tables, std::int32_t price, std::int32_t open_time, std::int32_t close_time);
+  dynamic_layout(std::int32_t tables, std::int32_t price);
+
+  std::int32_t tables_count() const {
+    return _tables_count;
+  }
+
+  std::int64_t bill(std::int32_t duration) const {
+    return billed_hours(duration) * _price;
+  }
+
+  table& operator[](std::int32_t table_id) {
+    return _tables[table_id];
+  }
+
+  const table& operator[](std::int32_t table_id) const {
+    return _tables[table_id];
+  }
+
+  std::size_t memory() const {
+    return _tables.capacity() * sizeof(table);
+  }
+
+private:
+  std::int32_t _tables_count;
+  std::int32_t _price;
+  std::vector<table> _tables;
+};
+
+// Table state for a club whose table count and price are known at compile time.
+template <std::int32_t Tables, std::int32_t Price>
+  requires (Tables > 0 && Price > 0)
+class fixed_layout {
+public:
+  static constexpr std::int32_t tables = Tables;
+  static constexpr std::int32_t price = Price;
+
+  fixed_layout(std::int32_t tables_count, std::int32_t price_per_hour) {
+    if (tables_count != Tables || price_per_hour != Price) {
+      throw std::invalid_argument("fixed_layout: club parameters do not match the layout");
+    }
+  }
+
+  static constexpr std::int32_t tables_count() {
+    return Tables;
+  }
+
+  static constexpr std::int64_t bill(std::int32_t duration) {
+    return billed_hours(duration) * Price;
+  }
+
+  table& operator[](std::int32_t table_id) {
+    return _tables[table_id];
+  }
+
+  const table& operator[](std::int32_t table_id) const {
+    return _tables[table_id];
+  }
+
+  std::size_t memory() const {
+    return sizeof(_tables);
+  }
+
+private:
+  std::array<table, Tables + 1> _tables{};
+};
+
+template <typename Layout>
+class basic_event_processor {
+public:
+  // Output is buffered and written to `out` at the end of each call of `process_event`, `process_events`
+  // or `close`; a long batch is also written in 64 KiB pieces as its output grows.
+  basic_event_processor(
+      std::int32_t tables,
+      std::int32_t price,
+      std::int32_t open_time,
+      std::int32_t close_time,
+      std::ostream& out = std::cout,
+      output_format format = output_format::text
+  );
   void process_event(const event& e);
+  // Same as calling `process_event` for each event in turn, with one write per 64 KiB of output
+  // instead of one per event.
+  void process_events(std::span<const event> events);
+  // Ends the day: closes the tables and forgets the clients still inside, so nothing carries over
+  // to the next day (see `begin_day`).
   void close();
+  // Starts another day on a closed processor: tables, queue and counters are reset in place and the
+  // containers keep the capacity of recent days, shrinking back after an unusually busy one.
+  void begin_day(std::int32_t open_time, std::int32_t close_time);
+
+  // Revenue and usage are final once the day is closed.
+  day_totals totals() const;
+
+  // For watching memory growth in a long-running feed.
+  processor_memory memory_report() const;
+
+  // Keeps an undo journal of the day, so that a `retract` event takes back the client's event at its
+  // `target_time`: the processor rolls back to just before that event and silently replays the ones
+  // after it, at a cost proportional to their number. Output already written stays; the retraction
+  // shows in the output that follows and in the day's totals. Without the journal a retraction is an
+  // error. Attached analytics and heatmaps keep what they recorded before a retraction.
+  void set_journal(bool enabled);
+
+  processor_state snapshot() const;
+  // Continues from a snapshot of a processor of the same club, as if it had processed the same events.
+  // Throws `std::invalid_argument` if the table count differs.
+  void restore(const processor_state& state);
+
+  // Writes pending output to the current stream, then sends further output to `out` in `format`.
+  void set_output(std::ostream& out, output_format format);
+
+  // Accumulates per-client spend, seat time, waits and turn-aways into `analytics` (not owned);
+  // nullptr detaches it.
+  void set_analytics(client_analytics* analytics) {
+    _analytics = analytics;
+  }
+
+  // Records every seating into `heatmap` (not owned, with at least this club's tables) and finishes
+  // it on `close`; nullptr detaches it.
+  void set_heatmap(occupancy_heatmap* heatmap) {
+    _heatmap = heatmap;
+  }
+
+  // Publishes the seating to `publisher` (not owned) whenever a call of `process_event`,
+  // `process_events`, `close` or `begin_day` changed it, for readers on other threads; nullptr
+  // detaches it.
+  void set_seating(seating_publisher* publisher) {
+    _seating = publisher;
+    _seating_changed = true;
+  }
 
 private:
-  static std::string format_time(std::int32_t minutes);
+  void dispatch(const event& e);
+  void prefetch(const event& e);
 
+  void write_event(std::int32_t time, std::int32_t id, std::string_view name, std::int32_t table_id = 0);
+  void write_error(std::int32_t time, std::string_view message);
+  void flush();
+  void publish_seating(std::int32_t time);
+
+  void bill_table(std::int32_t table_id, std::int32_t current_time);
   void close_table(std::int32_t table_id, std::int32_t current_time);
   void assign_next(std::int32_t table_id, std::int32_t current_time);
+  void compact();
 
   void enter(const event& e);
   void take(const event& e);
   void wait(const event& e);
   void leave(const event& e);
+  void retract(const event& e);
+  void clear_journal();
 
 private:
-  std::int32_t _tables_count;
-  std::int32_t _price;
+  Layout _layout;
   std::int32_t _open_time;
   std::int32_t _close_time;
 
-  std::unordered_set<std::string> _clients;
-  std::vector<table> _tables;
-  std::queue<std::string> _waiting;
-  bimap<std::string, std::int32_t> _client_table;
+  // Presence, seat and queue entries of every client, found with one lookup per event. Records of
+  // departed clients keep their name storage for later arrivals, so a warmed-up processor handles
+  // events without allocating.
+  client_index _clients;
+  // Most client records at once since the last `compact`.
+  std::size_t _peak_clients = 0;
+
+  std::int32_t _turn_aways = 0;
+  std::int32_t _errors = 0;
+  client_analytics* _analytics = nullptr;
+  occupancy_heatmap* _heatmap = nullptr;
+  seating_publisher* _seating = nullptr;
+  bool _seating_changed = false;
+
+  // Where the journal stood before an event of the history.
+  struct journal_mark {
+    std::size_t clients;
+    std::size_t tables;
+    std::int32_t turn_aways;
+    std::int32_t errors;
+    std::int32_t retraction_errors;
+  };
+
+  bool _journaling = false;
+  // The day's events so far, less the retracted ones, each with its mark. Only the first `_history_size`
+  // entries are live; the rest keep their names' storage for the next events.
+  std::vector<event> _history;
+  std::size_t _history_size = 0;
+  std::vector<journal_mark> _marks;
+  // Tables as they were before a bill changed them.
+  std::vector<std::pair<std::int32_t, table>> _table_undo;
+  // Errors of failed retractions, which are not in the history and survive a rollback.
+  std::int32_t _retraction_errors = 0;
+
+  std::ostream* _out;
+  output_encoder _encoder;
+  std::string _buffer;
 };
+
+using event_processor = basic_event_processor<dynamic_layout>;
+
+// Layouts compiled into the library; clubs with other parameters use `event_processor`.
+using common_layouts = std::tuple<
+    fixed_layout<3, 10>,
+    fixed_layout<5, 100>,
+    fixed_layout<10, 100>,
+    fixed_layout<20, 100>>;
+
+extern template class basic_event_processor<dynamic_layout>;
+extern template class basic_event_processor<fixed_layout<3, 10>>;
+extern template class basic_event_processor<fixed_layout<5, 100>>;
+extern template class basic_event_processor<fixed_layout<10, 100>>;
+extern template class basic_event_processor<fixed_layout<20, 100>>;
+
+namespace detail {
+template <typename F, typename... Layouts>
+bool dispatch_fixed(
+    std::tuple<Layouts...>*,
+    std::int32_t tables,
+    std::int32_t price,
+    std::int32_t open_time,
+    std::int32_t close_time,
+    std::ostream& out,
+    output_format format,
+    F& f
+) {
+  auto try_layout = [&]<typename Layout>(Layout*) {
+    if (Layout::tables != tables || Layout::price != price) {
+      return false;
+    }
+    basic_event_processor<Layout> processor(tables, price, open_time, close_time, out, format);
+    f(processor);
+    return true;
+  };
+  return (try_layout(static_cast<Layouts*>(nullptr)) || ...);
+}
+} // namespace detail
+
+// Calls `f` with a processor specialized for the club when one of `common_layouts` matches,
+// and with the run-time sized `event_processor` otherwise.
+template <typename F>
+void with_event_processor(
+    std::int32_t tables,
+    std::int32_t price,
+    std::int32_t open_time,
+    std::int32_t close_time,
+    std::ostream& out,
+    output_format format,
+    F&& f
+) {
+  auto* layouts = static_cast<common_layouts*>(nullptr);
+  if (!detail::dispatch_fixed(layouts, tables, price, open_time, close_time, out, format, f)) {
+    event_processor processor(tables, price, open_time, close_time, out, format);
+    f(processor);
+  }
+}
+
+// Text output to `std::cout`.
+template <typename F>
+void with_event_processor(std::int32_t tables, std::int32_t price, std::int32_t open_time, std::int32_t close_time, F&& f) {
+  with_event_processor(tables, price, open_time, close_time, std::cout, output_format::text, std::forward<F>(f));
+}
 } // namespace pc_club
 
 #endif // !__event_processor_h_
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef __event_source_h_
+#define __event_source_h_
+
+#include "event_parser.h"
+#include "event_processor.h"
+#include "generator.h"
+
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pc_club {
+// Lines without their terminating '\n'; each view is valid until the next line is pulled.
+using line_source = generator<std::string_view>;
+
+line_source read_lines(std::istream& in);
+
+// "-" reads standard input; pipes and FIFOs work like regular files. A missing file yields no lines.
+line_source read_file_lines(std::string path);
+
+// Views into `buffer`, which must outlive the source.
+line_source read_buffer_lines(std::string_view buffer);
+
+// Whole contents of a file ("-" reads standard input); empty if the file is missing.
+std::string read_file_contents(const std::string& path);
+
+// Consumes the three header lines. On failure `bad_line` holds the line to report.
+bool read_parameters(line_source& lines, club_parameters& parameters, std::string& bad_line);
+// Same for an in-memory input; on success `buffer` is left holding the event section.
+bool read_parameters(std::string_view& buffer, club_parameters& parameters, std::string& bad_line);
+
+// Parses and validates event lines until the source ends or a line is malformed; the malformed
+// line is stored in `bad_line` and ends the sequence. Retractions are accepted only with `corrections`.
+generator<event> parse_events(
+    line_source& lines,
+    std::int32_t tables,
+    std::optional<std::string>& bad_line,
+    bool corrections = false
+);
+
+// Merges time-ordered event sequences, e.g. the logs of a club's terminals, into one ordered by time;
+// events of the same minute come in source order, and each source's own order is kept. Holds one
+// pending event per source, so each event costs O(log k) for k sources. Stops as soon as one of the
+// sources sets `bad_line`, which they are expected to share.
+generator<event> merge_events(std::vector<generator<event>>& sources, const std::optional<std::string>& bad_line);
+
+template <typename Predicate>
+generator<event> filter_events(generator<event>& events, Predicate predicate) {
+  for (const event& e : events) {
+    if (predicate(e)) {
+      co_yield e;
+    }
+  }
+}
+
+template <typename Processor>
+void feed(generator<event>& events, Processor& processor) {
+  for (const event& e : events) {
+    processor.process_event(e);
+  }
+}
+} // namespace pc_club
+
+#endif // !__event_source_h_
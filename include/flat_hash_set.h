@@ -0,0 +1,372 @@
+#pragma once
+#ifndef __flat_hash_set_h_
+#define __flat_hash_set_h_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PC_CLUB_FLAT_HASH_SSE2
+#endif
+
+namespace pc_club {
+// The hash every name lookup uses; the parser stores it in the event so it is computed once per line.
+inline std::size_t hash_name(std::string_view name) {
+  return std::hash<std::string_view>()(name);
+}
+
+// Open addressing in the style of a Swiss table: slots are split into groups of 16, each with a
+// 16-byte array of control bytes holding 7 bits of the slot's hash (or an empty/deleted mark). A
+// lookup compares the control bytes of a whole group at once and only touches slots whose bits match,
+// so a hit or a miss usually costs one group.
+//
+// The table only places slots; what a slot holds and how it is compared is up to the caller, who
+// passes the key's hash along with a `match(slot)` predicate, and a `hash_of(slot)` function to the
+// operations that may move slots. Erased slots keep their contents for the next insertion to reuse,
+// and tombstones are cleared by rehashing in place, so a table that has reached its peak size no
+// longer allocates.
+template <typename Slot>
+class swiss_table {
+public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  // Index of the slot `match` accepts, or `npos`.
+  template <typename Match>
+  std::size_t find(std::size_t hash, Match&& match) const {
+    if (_size == 0) {
+      return npos;
+    }
+    const std::int8_t h2 = _h2(hash);
+    std::size_t found = npos;
+    _probe(hash, [&](std::size_t g) {
+      group ctrl = _group(g);
+      for (std::uint32_t bits = _match(ctrl, h2); bits != 0; bits &= bits - 1) {
+        std::size_t i = g * group_size + static_cast<std::size_t>(std::countr_zero(bits));
+        if (match(_slots[i])) {
+          found = i;
+          return i;
+        }
+      }
+      return _match(ctrl, empty) != 0 ? g * group_size : npos;
+    });
+    return found;
+  }
+
+  // Claims a slot for a key with `hash` that is not in the table yet; the caller fills it in.
+  template <typename HashOf>
+  std::size_t insert(std::size_t hash, HashOf&& hash_of) {
+    std::size_t i = _ctrl.empty() ? npos : _free_slot(hash);
+    if (i == npos || (_ctrl[i] == empty && _growth_left == 0)) {
+      if (_ctrl.empty()) {
+        _rehash(group_size, hash_of);
+      } else {
+        // Tombstones alone can push the table to its load limit; then rehashing at the same size is enough.
+        _rehash(_size * 16 <= _capacity() * 7 ? _capacity() : _capacity() * 2, hash_of);
+      }
+      i = _free_slot(hash);
+    }
+    if (_ctrl[i] == empty) {
+      _growth_left--;
+    }
+    _ctrl[i] = _h2(hash);
+    _size++;
+    return i;
+  }
+
+  void erase(std::size_t i) {
+    // A probe only moves past a group that has no empty slot, so in a group that still has one no
+    // probe sequence depends on this slot and it can become empty again.
+    if (_match(_group(i / group_size), empty) != 0) {
+      _ctrl[i] = empty;
+      _growth_left++;
+    } else {
+      _ctrl[i] = deleted;
+    }
+    _size--;
+  }
+
+  void clear() {
+    std::fill(_ctrl.begin(), _ctrl.end(), empty);
+    _size = 0;
+    _growth_left = _max_load(_capacity());
+  }
+
+  // Releases storage held for more than twice `expected` keys (and at least the current ones), so a
+  // table that once peaked does not keep that memory for good. Smaller slack is kept to avoid regrowing.
+  template <typename HashOf>
+  void compact(std::size_t expected, HashOf&& hash_of) {
+    std::size_t capacity = group_size;
+    while (_max_load(capacity) < std::max(expected, _size)) {
+      capacity *= 2;
+    }
+    if (_capacity() > capacity * 2) {
+      _rehash(capacity, hash_of);
+    }
+  }
+
+  Slot& operator[](std::size_t i) {
+    return _slots[i];
+  }
+
+  const Slot& operator[](std::size_t i) const {
+    return _slots[i];
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  std::size_t capacity() const {
+    return _capacity();
+  }
+
+  // Bytes of the control bytes and slots; storage the slots point to is the caller's to count.
+  std::size_t memory() const {
+    return _ctrl.capacity() + _slots.capacity() * sizeof(Slot);
+  }
+
+  template <typename F>
+  void for_each(F&& f) const {
+    for (std::size_t i = 0; i < _ctrl.size(); i++) {
+      if (_ctrl[i] >= 0) {
+        f(_slots[i]);
+      }
+    }
+  }
+
+  // Hint that `hash` is about to be looked up.
+  void prefetch(std::size_t hash) const {
+#if defined(__GNUC__) || defined(__clang__)
+    if (!_ctrl.empty()) {
+      __builtin_prefetch(_ctrl.data() + (_h1(hash) & _group_mask()) * group_size);
+    }
+#else
+    (void)hash;
+#endif
+  }
+
+private:
+  static constexpr std::size_t group_size = 16;
+  // Control bytes: a full slot holds the low 7 bits of its hash, so only marks have the sign bit.
+  static constexpr std::int8_t empty = -128;
+  static constexpr std::int8_t deleted = -2;
+
+  struct group {
+#ifdef PC_CLUB_FLAT_HASH_SSE2
+    __m128i ctrl;
+#else
+    const std::int8_t* ctrl;
+#endif
+  };
+
+  static std::size_t _h1(std::size_t hash) {
+    return hash >> 7;
+  }
+
+  static std::int8_t _h2(std::size_t hash) {
+    return static_cast<std::int8_t>(hash & 0x7F);
+  }
+
+  static std::size_t _max_load(std::size_t capacity) {
+    return capacity - capacity / 8;
+  }
+
+  std::size_t _capacity() const {
+    return _ctrl.size();
+  }
+
+  std::size_t _group_mask() const {
+    return _capacity() / group_size - 1;
+  }
+
+  group _group(std::size_t g) const {
+#ifdef PC_CLUB_FLAT_HASH_SSE2
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(_ctrl.data() + g * group_size))};
+#else
+    return {_ctrl.data() + g * group_size};
+#endif
+  }
+
+  // Bit i is set when control byte i of the group equals `value`.
+  static std::uint32_t _match(const group& g, std::int8_t value) {
+#ifdef PC_CLUB_FLAT_HASH_SSE2
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(g.ctrl, _mm_set1_epi8(value))));
+#else
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < group_size; i++) {
+      mask |= static_cast<std::uint32_t>(g.ctrl[i] == value) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Bit i is set when slot i of the group is empty or deleted.
+  static std::uint32_t _match_free(const group& g) {
+#ifdef PC_CLUB_FLAT_HASH_SSE2
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(g.ctrl));
+#else
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < group_size; i++) {
+      mask |= static_cast<std::uint32_t>(g.ctrl[i] < 0) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Groups are probed at triangular offsets from the home group, which visits every group once
+  // because the group count is a power of two.
+  template <typename F>
+  std::size_t _probe(std::size_t hash, F&& visit) const {
+    const std::size_t mask = _group_mask();
+    std::size_t g = _h1(hash) & mask;
+    for (std::size_t step = 1;; g = (g + step++) & mask) {
+      if (std::size_t i = visit(g); i != npos) {
+        return i;
+      }
+    }
+  }
+
+  // The first empty or deleted slot on the probe sequence of `hash`.
+  std::size_t _free_slot(std::size_t hash) const {
+    return _probe(hash, [&](std::size_t g) {
+      std::uint32_t bits = _match_free(_group(g));
+      return bits != 0 ? g * group_size + static_cast<std::size_t>(std::countr_zero(bits)) : npos;
+    });
+  }
+
+  template <typename HashOf>
+  void _rehash(std::size_t capacity, HashOf& hash_of) {
+    if (capacity == _capacity()) {
+      _drop_deleted(hash_of);
+      return;
+    }
+    std::vector<std::int8_t> old_ctrl = std::exchange(_ctrl, std::vector<std::int8_t>(capacity, empty));
+    std::vector<Slot> old_slots = std::exchange(_slots, std::vector<Slot>(capacity));
+    _growth_left = _max_load(capacity) - _size;
+    for (std::size_t i = 0; i < old_ctrl.size(); i++) {
+      if (old_ctrl[i] >= 0) {
+        std::size_t j = _free_slot(hash_of(old_slots[i]));
+        _ctrl[j] = old_ctrl[i];
+        std::swap(_slots[j], old_slots[i]);
+      }
+    }
+  }
+
+  // Rehashes at the same capacity without allocating: tombstones become empty, every live slot is
+  // marked deleted and then moved to the first free slot of its probe sequence, swapping with a slot
+  // still waiting to be placed when that one is taken.
+  template <typename HashOf>
+  void _drop_deleted(HashOf& hash_of) {
+    for (std::int8_t& c : _ctrl) {
+      c = c >= 0 ? deleted : empty;
+    }
+    for (std::size_t i = 0; i < _ctrl.size(); i++) {
+      if (_ctrl[i] != deleted) {
+        continue;
+      }
+      std::size_t hash = hash_of(_slots[i]);
+      std::size_t j = _free_slot(hash);
+      if (j / group_size == i / group_size) {
+        _ctrl[i] = _h2(hash);
+        continue;
+      }
+      bool pending = _ctrl[j] == deleted;
+      _ctrl[j] = _h2(hash);
+      std::swap(_slots[i], _slots[j]);
+      if (pending) {
+        i--;
+      } else {
+        _ctrl[i] = empty;
+      }
+    }
+    _growth_left = _max_load(_capacity()) - _size;
+  }
+
+  std::vector<std::int8_t> _ctrl;
+  std::vector<Slot> _slots;
+  std::size_t _size = 0;
+  std::size_t _growth_left = 0;
+};
+
+// A set of strings on a `swiss_table`, each stored with its hash. Callers pass the key's
+// `hash_name` in. Erased slots keep their string's storage for the next insertion.
+class flat_hash_set {
+public:
+  bool contains(std::string_view name, std::size_t hash) const {
+    return _find(name, hash) != _table.npos;
+  }
+
+  // Returns false if the name was already present.
+  bool insert(std::string_view name, std::size_t hash) {
+    if (contains(name, hash)) {
+      return false;
+    }
+    slot& s = _table[_table.insert(hash, hash_of)];
+    s.name.assign(name);
+    s.hash = hash;
+    return true;
+  }
+
+  // Returns false if the name was not present.
+  bool erase(std::string_view name, std::size_t hash) {
+    std::size_t i = _find(name, hash);
+    if (i == _table.npos) {
+      return false;
+    }
+    _table.erase(i);
+    return true;
+  }
+
+  void clear() {
+    _table.clear();
+  }
+
+  std::size_t size() const {
+    return _table.size();
+  }
+
+  std::size_t capacity() const {
+    return _table.capacity();
+  }
+
+  // See `swiss_table::compact`.
+  void compact(std::size_t expected) {
+    _table.compact(expected, hash_of);
+  }
+
+  template <typename F>
+  void for_each(F&& f) const {
+    _table.for_each([&](const slot& s) { f(std::string_view(s.name)); });
+  }
+
+  void prefetch(std::size_t hash) const {
+    _table.prefetch(hash);
+  }
+
+private:
+  struct slot {
+    std::string name;
+    std::size_t hash = 0;
+  };
+
+  static std::size_t hash_of(const slot& s) {
+    return s.hash;
+  }
+
+  std::size_t _find(std::string_view name, std::size_t hash) const {
+    return _table.find(hash, [&](const slot& s) { return s.hash == hash && s.name == name; });
+  }
+
+  swiss_table<slot> _table;
+};
+} // namespace pc_club
+
+#endif // !__flat_hash_set_h_
@@ -0,0 +1,27 @@
+#pragma once
+#ifndef __follow_source_h_
+#define __follow_source_h_
+
+#include "event_source.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace pc_club {
+struct follow_options {
+  // The source ends once this passes; may be set after the source has started (e.g. from the header).
+  std::optional<std::chrono::system_clock::time_point> deadline;
+};
+
+// Wall-clock time of `minutes` past today's local midnight.
+std::chrono::system_clock::time_point today_at(std::int32_t minutes);
+
+// Tails a growing file or a FIFO ("-" for stdin), yielding each line as soon as it is complete.
+// Waits on inotify (files) or poll (FIFOs and stdin) rather than sleeping. Ends on the deadline,
+// when a FIFO's writers close, or when a followed file is deleted or renamed.
+line_source follow_file_lines(std::string path, const follow_options& options);
+} // namespace pc_club
+
+#endif // !__follow_source_h_
@@ -0,0 +1,145 @@
+#pragma once
+#ifndef __generator_h_
+#define __generator_h_
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace pc_club {
+// Lazily produced sequence of `T`, pulled by iterating. Yielded values are only valid until the next pull.
+// `begin()` resumes where the previous iteration stopped, so a source can be consumed in several passes
+// (e.g. the header lines first, then the events).
+template <typename T>
+class generator {
+public:
+  struct promise_type {
+    const T* value = nullptr;
+    std::exception_ptr exception;
+
+    generator get_return_object() {
+      return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always yield_value(const T& v) noexcept {
+      value = std::addressof(v);
+      return {};
+    }
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() {
+      exception = std::current_exception();
+    }
+  };
+
+  class iterator {
+  public:
+    using value_type = T;
+    using reference = const T&;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    reference operator*() const {
+      return *_generator->_handle.promise().value;
+    }
+
+    const T* operator->() const {
+      return _generator->_handle.promise().value;
+    }
+
+    iterator& operator++() {
+      _generator->next();
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    friend bool operator==(const iterator& it, std::default_sentinel_t) {
+      return it._generator->done();
+    }
+
+  private:
+    friend class generator;
+
+    explicit iterator(generator* g)
+        : _generator(g) {}
+
+    generator* _generator = nullptr;
+  };
+
+  generator() = default;
+
+  generator(generator&& other) noexcept
+      : _handle(std::exchange(other._handle, nullptr)) {}
+
+  generator& operator=(generator&& other) noexcept {
+    if (this != &other) {
+      if (_handle) {
+        _handle.destroy();
+      }
+      _handle = std::exchange(other._handle, nullptr);
+    }
+    return *this;
+  }
+
+  generator(const generator&) = delete;
+  generator& operator=(const generator&) = delete;
+
+  ~generator() {
+    if (_handle) {
+      _handle.destroy();
+    }
+  }
+
+  // Advances to the next value; returns false once the sequence is exhausted.
+  bool next() {
+    if (done()) {
+      return false;
+    }
+    _handle.resume();
+    if (auto exception = std::exchange(_handle.promise().exception, nullptr)) {
+      std::rethrow_exception(exception);
+    }
+    return !_handle.done();
+  }
+
+  const T& value() const {
+    return *_handle.promise().value;
+  }
+
+  bool done() const {
+    return !_handle || _handle.done();
+  }
+
+  iterator begin() {
+    next();
+    return iterator(this);
+  }
+
+  std::default_sentinel_t end() {
+    return {};
+  }
+
+private:
+  explicit generator(std::coroutine_handle<promise_type> handle)
+      : _handle(handle) {}
+
+  std::coroutine_handle<promise_type> _handle;
+};
+} // namespace pc_club
+
+#endif // !__generator_h_
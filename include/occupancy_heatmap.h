@@ -0,0 +1,66 @@
+#pragma once
+#ifndef __occupancy_heatmap_h_
+#define __occupancy_heatmap_h_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace pc_club {
+// Per-minute count of occupied tables over a day, for each table and for the club.
+//
+// Seating intervals are recorded into a difference array (+1 at the start minute, -1 at the end
+// one), so recording is O(1); `finish` turns it into counts with one prefix-sum pass. Minutes are
+// the outer dimension, so the pass adds whole rows of tables, which the compiler vectorizes.
+class occupancy_heatmap {
+public:
+  static constexpr std::int32_t minutes = 24 * 60;
+
+  explicit occupancy_heatmap(std::int32_t tables);
+
+  std::int32_t tables() const {
+    return _tables;
+  }
+
+  // Table `table_id` (1-based) was occupied during [from, to), clipped to the day. An interval that is
+  // empty after clipping, such as one that ends before it starts, records nothing.
+  void record(std::int32_t table_id, std::int32_t from, std::int32_t to) {
+    from = std::max(from, 0);
+    to = std::min(to, minutes);
+    if (from >= to) {
+      return;
+    }
+    _diff[static_cast<std::size_t>(from) * _row + static_cast<std::size_t>(table_id - 1)]++;
+    _diff[static_cast<std::size_t>(to) * _row + static_cast<std::size_t>(table_id - 1)]--;
+  }
+
+  // Computes the counts from everything recorded so far; may be called again after more records.
+  void finish();
+
+  // Valid after `finish`.
+  std::int32_t occupancy(std::int32_t table_id, std::int32_t minute) const {
+    return _counts[static_cast<std::size_t>(minute) * _row + static_cast<std::size_t>(table_id - 1)];
+  }
+
+  std::int32_t club(std::int32_t minute) const {
+    return _club[static_cast<std::size_t>(minute)];
+  }
+
+  // `minute,club,1,...,n` with one row per minute.
+  void write_csv(std::ostream& out) const;
+  // Little-endian int32 values: the table count, then per minute the club count followed by each table's.
+  void write_binary(std::ostream& out) const;
+
+private:
+  std::int32_t _tables;
+  std::size_t _row;
+  // `minutes + 1` rows, so an interval may end at midnight.
+  std::vector<std::int32_t> _diff;
+  std::vector<std::int32_t> _counts;
+  std::vector<std::int32_t> _club;
+};
+} // namespace pc_club
+
+#endif // !__occupancy_heatmap_h_
@@ -0,0 +1,103 @@
+#pragma once
+#ifndef __output_encoder_h_
+#define __output_encoder_h_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace pc_club {
+enum class output_format : std::uint8_t {
+  text,
+  csv,
+  jsonl,
+  binary,
+  // Writes nothing; for runs that only need the processor's totals.
+  none
+};
+
+// Accepts "text", "csv", "jsonl", "binary" and "none".
+bool parse_output_format(std::string_view name, output_format& format);
+
+enum class record_kind : std::uint8_t {
+  open = 1,
+  event = 2,
+  close = 3,
+  table = 4,
+  input_error = 5,
+  // Carries the next bytes of the previous record's name in its `name` field.
+  continuation = 6
+};
+
+// One record of the binary encoding: 64 bytes, little-endian, no padding between fields. A stream
+// of them can be read in place (e.g. from an mmap-ed file) through `binary_records`.
+struct binary_record {
+  static constexpr std::size_t inline_name = 32;
+
+  record_kind kind;
+  std::uint8_t id;          // Event id for `event` records.
+  std::uint16_t reserved0;
+  std::uint32_t name_size;  // Full name length; bytes past `inline_name` follow in continuation records.
+  std::int32_t time;        // Minutes since midnight.
+  std::int32_t table;       // 0 when the record has no table.
+  std::int32_t usage;       // Minutes, for `table` records; the retracted event's time for retractions.
+  std::uint32_t reserved1;
+  std::int64_t revenue;     // For `table` records.
+  char name[inline_name];   // Zero-padded.
+};
+
+static_assert(sizeof(binary_record) == 64);
+
+// Views a buffer of binary output as records without copying; `bytes` must be suitably aligned
+// and hold whole records. Only meaningful on little-endian hosts.
+std::span<const binary_record> binary_records(std::span<const std::byte> bytes);
+
+// Appends output records in one encoding to a caller-owned buffer. Nothing is allocated beyond
+// the buffer's own growth, so a reserved buffer keeps encoding allocation-free.
+//
+// text:   the format of the task statement (`HH:MM id name [table]`, `table revenue HH:MM`).
+// csv:    `record,time,id,name,table,revenue,usage` rows; times and durations are in minutes.
+// jsonl:  one object per line with the same fields, omitting empty ones.
+// binary: one `binary_record` per record (plus continuations for long names).
+//
+// A retraction's second time is its `usage` in csv and binary and its `target_time` in jsonl.
+class output_encoder {
+public:
+  explicit output_encoder(output_format format = output_format::text);
+
+  output_format format() const {
+    return _format;
+  }
+
+  // Stream preamble, written once before any record (the CSV column names).
+  void begin(std::string& out) const;
+
+  void open(std::string& out, std::int32_t time) const;
+  // `table` is 0 for events without one.
+  void event(std::string& out, std::int32_t time, std::int32_t id, std::string_view name, std::int32_t table = 0) const;
+  // An event 5, echoed with the time of the event it takes back.
+  void retraction(std::string& out, std::int32_t time, std::string_view name, std::int32_t target_time) const;
+  void close(std::string& out, std::int32_t time) const;
+  void table(std::string& out, std::int32_t table_id, std::int64_t revenue, std::int32_t usage) const;
+  // A malformed input line, reported verbatim.
+  void input_error(std::string& out, std::string_view line) const;
+
+private:
+  void _record(
+      std::string& out,
+      record_kind kind,
+      std::int32_t time,
+      std::int32_t id,
+      std::string_view name,
+      std::int32_t table,
+      std::int64_t revenue,
+      std::int32_t usage
+  ) const;
+
+  output_format _format;
+};
+} // namespace pc_club
+
+#endif // !__output_encoder_h_
@@ -0,0 +1,38 @@
+#pragma once
+#ifndef __parallel_parser_h_
+#define __parallel_parser_h_
+
+#include "event_parser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pc_club {
+struct parallel_parse_options {
+  // Worker count; 0 uses the hardware concurrency.
+  unsigned threads = 0;
+  // Sections are split into chunks of at least this many bytes, so small inputs stay on one thread.
+  std::size_t min_chunk = 1 << 20;
+  // Accept retractions, as `parse_event` does with `corrections`.
+  bool corrections = false;
+};
+
+// Parses the event section of an in-memory input (the lines after the header) on several threads.
+// The section is cut into chunks at line boundaries, each chunk is parsed into its own buffer and the
+// buffers are joined in input order. Lines are split as by `read_buffer_lines`.
+//
+// As with `parse_events`, the first malformed line ends the sequence: it is stored in `bad_line` and
+// only the events before it are returned.
+std::vector<event> parse_events_parallel(
+    std::string_view section,
+    std::int32_t tables,
+    std::optional<std::string>& bad_line,
+    const parallel_parse_options& options = {}
+);
+} // namespace pc_club
+
+#endif // !__parallel_parser_h_
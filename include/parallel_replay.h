@@ -0,0 +1,38 @@
+#pragma once
+#ifndef __parallel_replay_h_
+#define __parallel_replay_h_
+
+#include "event_parser.h"
+#include "event_processor.h"
+#include "output_encoder.h"
+
+#include <cstddef>
+#include <ostream>
+#include <span>
+
+namespace pc_club {
+struct parallel_replay_options {
+  // Worker count; 0 uses the hardware concurrency.
+  unsigned threads = 0;
+  // Segments hold at least this many events, so small days are replayed on one thread.
+  std::size_t min_segment = 1 << 16;
+};
+
+// Processes one parsed day and closes it, writing to `out` exactly what a single processor would.
+//
+// A sequential pre-pass without output processes the events and snapshots the processor at the start
+// of every segment; the segments are then processed again and encoded on their own threads, each from
+// its snapshot into its own buffer, and the buffers are written in order. Only the encoding runs in
+// parallel: the pre-pass processes every segment but the last in order, so the speed-up is bounded by
+// the encoding's share of a sequential run and the CPU time roughly doubles; with `output_format::none`
+// nothing is gained. With one segment the day is processed directly.
+void replay_parallel(
+    std::span<const event> events,
+    const club_parameters& club,
+    std::ostream& out,
+    output_format format,
+    const parallel_replay_options& options = {}
+);
+} // namespace pc_club
+
+#endif // !__parallel_replay_h_
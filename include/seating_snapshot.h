@@ -0,0 +1,57 @@
+#pragma once
+#ifndef __seating_snapshot_h_
+#define __seating_snapshot_h_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pc_club {
+// Who sits where at one point of the day. Published snapshots are never modified, so any number of
+// readers may iterate them without locking while the processor goes on.
+struct seating {
+  // Increases with every published snapshot of the same publisher.
+  std::uint64_t version = 0;
+  // Time of the last event reflected.
+  std::int32_t time = 0;
+  // The client at table i + 1, or an empty name for a free table.
+  std::vector<std::string> names;
+
+  std::string_view at(std::int32_t table_id) const {
+    return names[static_cast<std::size_t>(table_id - 1)];
+  }
+};
+
+// Hands the latest seating from one writer (a processor, see `basic_event_processor::set_seating`)
+// to any number of reader threads.
+//
+// `snapshot` is a single atomic load. A superseded snapshot is reclaimed when its last reader drops
+// it; the writer keeps a few of them and refills one no reader holds any more, so a steady feed
+// publishes without allocating.
+class seating_publisher {
+public:
+  // Reader side: the latest published seating, nullptr before the first one.
+  std::shared_ptr<const seating> snapshot() const {
+    return _current.load(std::memory_order_acquire);
+  }
+
+  // Writer side: a snapshot to fill for `tables` tables, not visible to readers until `publish`.
+  seating& prepare(std::int32_t tables);
+  void publish(std::int32_t time);
+
+private:
+  static constexpr std::size_t pool_size = 4;
+
+  std::atomic<std::shared_ptr<const seating>> _current;
+  // Snapshots owned by the writer; one whose only owner is this pool can be refilled.
+  std::vector<std::shared_ptr<seating>> _pool;
+  std::shared_ptr<seating> _next;
+  std::uint64_t _version = 0;
+};
+} // namespace pc_club
+
+#endif // !__seating_snapshot_h_
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef __sweep_h_
+#define __sweep_h_
+
+#include "event_parser.h"
+#include "event_processor.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pc_club {
+struct sweep_config {
+  std::int32_t tables;
+  std::int32_t price;
+};
+
+struct sweep_result {
+  sweep_config config;
+  day_totals totals;
+};
+
+// Replays one parsed day under every configuration, spread over `threads` workers (0 uses the
+// hardware concurrency). The events are shared read-only by all runs; nothing is written.
+// Results are in the order of `configs`.
+//
+// The events were validated against `club.tables`, so a configuration with fewer tables is rejected
+// with `std::invalid_argument`.
+std::vector<sweep_result> run_sweep(
+    std::span<const event> events,
+    const club_parameters& club,
+    std::span<const sweep_config> configs,
+    unsigned threads = 0
+);
+} // namespace pc_club
+
+#endif // !__sweep_h_
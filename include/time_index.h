@@ -0,0 +1,47 @@
+#pragma once
+#ifndef __time_index_h_
+#define __time_index_h_
+
+#include "event_processor.h"
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pc_club {
+// A point to resume a day from: the byte offset of the first event at or after `minute` and the
+// processor state just before it.
+struct checkpoint {
+  std::int32_t minute;
+  std::uint64_t offset;
+  processor_state state;
+};
+
+// Sparse index of an input file, kept next to it in a sidecar file (see `index_path`).
+struct time_index {
+  // Identify the indexed input: an index whose size or header differs from the file is stale.
+  std::uint64_t input_size = 0;
+  std::string header;
+  // Ordered by minute.
+  std::vector<checkpoint> checkpoints;
+
+  // The last checkpoint at or before `minute`, or nullptr.
+  const checkpoint* find(std::int32_t minute) const;
+};
+
+std::string index_path(const std::string& input_path);
+
+// Processes the day in `input` and checkpoints it every `interval` minutes of event time. Fails on a
+// malformed line, which is stored in `bad_line`.
+bool build_time_index(std::string_view input, std::int32_t interval, time_index& index, std::string& bad_line);
+
+// A line-oriented text format; names contain no spaces, so they need no quoting.
+void write_time_index(std::ostream& out, const time_index& index);
+std::optional<time_index> read_time_index(std::istream& in);
+} // namespace pc_club
+
+#endif // !__time_index_h_
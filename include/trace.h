@@ -0,0 +1,68 @@
+#pragma once
+#ifndef __trace_h_
+#define __trace_h_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pc_club {
+// Collects timestamped spans and writes them as a Chrome trace (opens in Perfetto / chrome://tracing).
+class trace_recorder {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit trace_recorder(std::uint32_t sample_every = 1);
+
+  // Span names must outlive the recorder (string literals are expected).
+  void record(const char* name, clock::time_point start, clock::time_point end);
+
+  // Returns true on every `sample_every`-th call; used to thin out per-event spans.
+  bool sample();
+
+  bool write(const std::string& path) const;
+
+  std::size_t size() const;
+
+private:
+  struct span_record {
+    const char* name;
+    std::int64_t start_ns;
+    std::int64_t duration_ns;
+  };
+
+  clock::time_point _origin;
+  std::uint32_t _sample_every;
+  std::uint32_t _sample_counter;
+  std::vector<span_record> _spans;
+};
+
+// Records a span over its own lifetime. A null recorder makes it a no-op.
+class trace_span {
+public:
+  trace_span(trace_recorder* recorder, const char* name)
+      : _recorder(recorder)
+      , _name(name) {
+    if (_recorder) {
+      _start = trace_recorder::clock::now();
+    }
+  }
+
+  trace_span(const trace_span&) = delete;
+  trace_span& operator=(const trace_span&) = delete;
+
+  ~trace_span() {
+    if (_recorder) {
+      _recorder->record(_name, _start, trace_recorder::clock::now());
+    }
+  }
+
+private:
+  trace_recorder* _recorder;
+  const char* _name;
+  trace_recorder::clock::time_point _start{};
+};
+} // namespace pc_club
+
+#endif // !__trace_h_
@@ -0,0 +1,86 @@
+#include "client_analytics.h"
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+namespace {
+// Better spender first: higher spend, then the smaller name.
+bool spends_more(
+    const std::pair<std::string_view, pc_club::client_stats>& lhs,
+    const std::pair<std::string_view, pc_club::client_stats>& rhs
+) {
+  if (lhs.second.spend != rhs.second.spend) {
+    return lhs.second.spend > rhs.second.spend;
+  }
+  return lhs.first < rhs.first;
+}
+} // namespace
+
+std::size_t pc_club::client_analytics::_find(std::string_view name, std::size_t hash) const {
+  return _table.find(hash, [&](const slot& s) { return s.hash == hash && s.name == name; });
+}
+
+pc_club::client_stats& pc_club::client_analytics::_stats(std::string_view name, std::size_t hash) {
+  std::size_t i = _find(name, hash);
+  if (i == _table.npos) {
+    i = _table.insert(hash, hash_of);
+    slot& s = _table[i];
+    s.name.assign(name);
+    s.stats = {};
+    s.hash = hash;
+  }
+  return _table[i].stats;
+}
+
+pc_club::client_stats& pc_club::client_analytics::operator[](std::string_view name) {
+  return _stats(name, hash_name(name));
+}
+
+const pc_club::client_stats* pc_club::client_analytics::find(std::string_view name) const {
+  std::size_t i = _find(name, hash_name(name));
+  return i == _table.npos ? nullptr : &_table[i].stats;
+}
+
+void pc_club::client_analytics::record_session(std::string_view name, std::int32_t duration, std::int64_t cost) {
+  client_stats& stats = (*this)[name];
+  stats.spend += cost;
+  stats.seat_time += duration;
+}
+
+void pc_club::client_analytics::record_wait(std::string_view name) {
+  (*this)[name].waits++;
+}
+
+void pc_club::client_analytics::record_turn_away(std::string_view name) {
+  (*this)[name].turn_aways++;
+}
+
+void pc_club::client_analytics::merge(const client_analytics& other) {
+  other._table.for_each([this](const slot& s) { _stats(s.name, s.hash) += s.stats; });
+}
+
+std::vector<std::pair<std::string_view, pc_club::client_stats>>
+pc_club::client_analytics::top_spenders(std::size_t k) const {
+  using entry = std::pair<std::string_view, client_stats>;
+  // Min-heap of the best `k` so far: its top is the weakest kept entry.
+  std::priority_queue<entry, std::vector<entry>, decltype(&spends_more)> heap(spends_more);
+  if (k != 0) {
+    _table.for_each([&](const slot& s) {
+      entry candidate(s.name, s.stats);
+      if (heap.size() < k) {
+        heap.push(candidate);
+      } else if (spends_more(candidate, heap.top())) {
+        heap.pop();
+        heap.push(candidate);
+      }
+    });
+  }
+  std::vector<entry> top;
+  top.reserve(heap.size());
+  for (; !heap.empty(); heap.pop()) {
+    top.push_back(heap.top());
+  }
+  std::reverse(top.begin(), top.end());
+  return top;
+}
@@ -0,0 +1,214 @@
+#include "client_index.h"
+
+#include <algorithm>
+
+pc_club::client_index::client_index(std::int32_t tables)
+    : _by_table(static_cast<std::size_t>(tables) + 1, none)
+    , _queue(static_cast<std::size_t>(tables)) {}
+
+pc_club::client_index::id pc_club::client_index::find(std::string_view name, std::size_t hash) const {
+  std::size_t slot = _by_name.find(hash, [&](id client) {
+    return _records[client].hash == hash && _records[client].name == name;
+  });
+  return slot == _by_name.npos ? none : _by_name[slot];
+}
+
+pc_club::client_index::id pc_club::client_index::find_or_insert(std::string_view name, std::size_t hash) {
+  if (id client = find(name, hash); client != none) {
+    return client;
+  }
+  id client = 0;
+  if (_free.empty()) {
+    client = static_cast<id>(_records.size());
+    _records.emplace_back();
+    _log(change::kind::appended, client);
+  } else {
+    client = _free.back();
+    _free.pop_back();
+    _log(change::kind::reused, client);
+  }
+  client_record& record = _records[client];
+  record.name.assign(name);
+  record.hash = hash;
+  record.table = 0;
+  record.queued = 0;
+  record.present = false;
+  _by_name[_by_name.insert(hash, [this](id c) { return _hash_of(c); })] = client;
+  return client;
+}
+
+void pc_club::client_index::set_present(id client, bool present) {
+  _log_record(client);
+  _records[client].present = present;
+}
+
+bool pc_club::client_index::seat(id client, std::int32_t table_id, std::int32_t time) {
+  client_record& record = _records[client];
+  if (record.table != 0) {
+    return false;
+  }
+  _log_record(client);
+  record.table = table_id;
+  record.seated_since = time;
+  _by_table[static_cast<std::size_t>(table_id)] = client;
+  _seated++;
+  return true;
+}
+
+void pc_club::client_index::unseat(std::int32_t table_id) {
+  id& client = _by_table[static_cast<std::size_t>(table_id)];
+  if (client == none) {
+    return;
+  }
+  _log_record(client);
+  _records[client].table = 0;
+  client = none;
+  _seated--;
+}
+
+void pc_club::client_index::enqueue(id client) {
+  _log_queue();
+  _log_record(client);
+  _queue[(_queue_head + _queue_size) % _queue.size()] = client;
+  _queue_size++;
+  _records[client].queued++;
+}
+
+pc_club::client_index::id pc_club::client_index::dequeue() {
+  if (_queue_size == 0) {
+    return none;
+  }
+  id client = _queue[_queue_head];
+  _log_queue();
+  _log_record(client);
+  _queue_head = (_queue_head + 1) % _queue.size();
+  _queue_size--;
+  _records[client].queued--;
+  return client;
+}
+
+void pc_club::client_index::release(id client) {
+  const client_record& record = _records[client];
+  if (record.present || record.table != 0 || record.queued != 0) {
+    return;
+  }
+  _by_name.erase(_slot_of(client));
+  if (_journaling) {
+    _log(change::kind::released, client);
+  } else {
+    _free.push_back(client);
+  }
+}
+
+void pc_club::client_index::clear() {
+  _by_name.clear();
+  std::fill(_by_table.begin(), _by_table.end(), none);
+  _seated = 0;
+  _queue_head = 0;
+  _queue_size = 0;
+  _journal.clear();
+  // Lowest ids are handed out first, so a day reuses the records in the order of the previous one.
+  _free.resize(_records.size());
+  for (std::size_t i = 0; i < _free.size(); i++) {
+    _free[i] = static_cast<id>(_free.size() - 1 - i);
+  }
+}
+
+void pc_club::client_index::undo(std::size_t mark) {
+  for (; _journal.size() > mark; _journal.pop_back()) {
+    const change& c = _journal.back();
+    switch (c.what) {
+    case change::kind::record: {
+      client_record& record = _records[c.client];
+      if (record.table != 0) {
+        _by_table[static_cast<std::size_t>(record.table)] = none;
+        _seated--;
+      }
+      if (c.table != 0) {
+        _by_table[static_cast<std::size_t>(c.table)] = c.client;
+        _seated++;
+      }
+      record.table = c.table;
+      record.seated_since = c.seated_since;
+      record.queued = c.queued;
+      record.present = c.present;
+      break;
+    }
+    case change::kind::reused:
+      _by_name.erase(_slot_of(c.client));
+      _free.push_back(c.client);
+      break;
+    case change::kind::appended:
+      // Undone newest first, so the record is still the last one.
+      _by_name.erase(_slot_of(c.client));
+      _records.pop_back();
+      break;
+    case change::kind::released:
+      _by_name[_by_name.insert(_hash_of(c.client), [this](id other) { return _hash_of(other); })] = c.client;
+      break;
+    case change::kind::queue:
+      _queue_head = c.queue_head;
+      _queue_size = c.queue_size;
+      _queue[(_queue_head + _queue_size) % _queue.size()] = c.slot;
+      break;
+    }
+  }
+}
+
+void pc_club::client_index::compact(std::size_t expected) {
+  _by_name.compact(expected, [this](id c) { return _hash_of(c); });
+  if (_by_name.size() == 0 && _records.size() > 2 * expected) {
+    _records.resize(expected);
+    _records.shrink_to_fit();
+    clear();
+  }
+}
+
+pc_club::client_index::memory_usage pc_club::client_index::memory() const {
+  const std::size_t inline_capacity = std::string().capacity();
+  std::size_t names = 0;
+  for (const client_record& record : _records) {
+    if (record.name.capacity() > inline_capacity) {
+      names += record.name.capacity() + 1;
+    }
+  }
+  return {
+      .records = _records.capacity() * sizeof(client_record) + _free.capacity() * sizeof(id),
+      .names = names,
+      .name_index = _by_name.memory(),
+      .table_index = _by_table.capacity() * sizeof(id),
+      .queue = _queue.capacity() * sizeof(id)
+  };
+}
+
+void pc_club::client_index::_log(change::kind what, id client) {
+  if (_journaling) {
+    _journal.push_back({.what = what, .client = client});
+  }
+}
+
+void pc_club::client_index::_log_record(id client) {
+  if (_journaling) {
+    const client_record& record = _records[client];
+    _journal.push_back({
+        .what = change::kind::record,
+        .client = client,
+        .table = record.table,
+        .seated_since = record.seated_since,
+        .queued = record.queued,
+        .present = record.present
+    });
+  }
+}
+
+void pc_club::client_index::_log_queue() {
+  if (_journaling) {
+    _journal.push_back({
+        .what = change::kind::queue,
+        .client = none,
+        .queue_head = _queue_head,
+        .queue_size = _queue_size,
+        .slot = _queue[(_queue_head + _queue_size) % _queue.size()]
+    });
+  }
+}
@@ -0,0 +1,127 @@
+#include "event_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <string>
+
+namespace {
+bool is_digit(char c) {
+  return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+bool is_space(char c) {
+  return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+std::int32_t parse_two_digits(std::string_view str) {
+  if (!is_digit(str[0]) || !is_digit(str[1])) {
+    return -1;
+  }
+  return (str[0] - '0') * 10 + (str[1] - '0');
+}
+
+bool parse_positive(std::string_view line, std::int32_t& value) {
+  try {
+    value = std::stoi(std::string(line));
+  } catch (...) {
+    return false;
+  }
+  return value > 0;
+}
+} // namespace
+
+std::int32_t pc_club::parse_time(std::string_view str) {
+  if (str.size() != 5 || str[2] != ':') {
+    return -1;
+  }
+  std::int32_t h = parse_two_digits(str.substr(0, 2));
+  std::int32_t m = parse_two_digits(str.substr(3, 2));
+  if (h < 0 || h > 23 || m < 0 || m > 59) {
+    return -1;
+  }
+  return h * 60 + m;
+}
+
+bool pc_club::parse_event(std::string_view line, std::int32_t tables, event& e, bool corrections) {
+  std::array<std::string_view, 4> tokens;
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < line.size();) {
+    if (is_space(line[i])) {
+      i++;
+      continue;
+    }
+    std::size_t end = i;
+    while (end < line.size() && !is_space(line[end])) {
+      end++;
+    }
+    if (count == tokens.size()) {
+      return false;
+    }
+    tokens[count++] = line.substr(i, end - i);
+    i = end;
+  }
+  if (count != 3 && count != 4) {
+    return false;
+  }
+
+  if (tokens[1].size() != 1 || tokens[1][0] < '1' || tokens[1][0] > (corrections ? '5' : '4')) {
+    return false;
+  }
+  if (!std::all_of(tokens[2].begin(), tokens[2].end(), [](unsigned char c) {
+        return std::islower(c) || std::isdigit(c) || c == '_';
+      })) {
+    return false;
+  }
+  std::int32_t table = -1;
+  std::int32_t target_time = -1;
+  if (tokens[1][0] == '5') {
+    // `HH:MM 5 name HH:MM`: the second time is the client's event to take back.
+    if (count != 4) {
+      return false;
+    }
+    target_time = parse_time(tokens[3]);
+    if (target_time == -1) {
+      return false;
+    }
+  } else if (count == 4) {
+    if (tokens[1][0] != '2' || !std::all_of(tokens[3].begin(), tokens[3].end(), is_digit)) {
+      return false;
+    }
+    auto [ptr, ec] = std::from_chars(tokens[3].data(), tokens[3].data() + tokens[3].size(), table);
+    if (ec != std::errc() || table < 1 || table > tables) {
+      return false;
+    }
+  } else if (tokens[1][0] == '2') {
+    return false;
+  }
+  std::int32_t time = parse_time(tokens[0]);
+  if (time == -1 || target_time > time) {
+    return false;
+  }
+  e.time = time;
+  e.type = static_cast<event_type>(tokens[1][0] - '0');
+  e.name.assign(tokens[2]);
+  e.name_hash = hash_name(e.name);
+  e.table = table;
+  e.target_time = target_time;
+  return true;
+}
+
+bool pc_club::parse_tables(std::string_view line, std::int32_t& tables) {
+  return parse_positive(line, tables);
+}
+
+bool pc_club::parse_hours(std::string_view line, std::int32_t& open_time, std::int32_t& close_time) {
+  if (line.size() < 11) {
+    return false;
+  }
+  open_time = parse_time(line.substr(0, 5));
+  close_time = parse_time(line.substr(6, 5));
+  return open_time != -1 && close_time != -1 && open_time <= close_time;
+}
+
+bool pc_club::parse_price(std::string_view line, std::int32_t& price) {
+  return parse_positive(line, price);
+}
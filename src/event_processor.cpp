@@ -1,109 +1,268 @@
 #include "event_processor.h"
 
 #include <algorithm>
-#include <iostream>
-#include <limits>
-#include <sstream>
+#include <iterator>
+#include <utility>
 
-pc_club::event_processor::event_processor(
+namespace {
+std::size_t name_hash(const pc_club::event& e) {
+  return e.name_hash != 0 ? e.name_hash : pc_club::hash_name(e.name);
+}
+} // namespace
+
+pc_club::dynamic_layout::dynamic_layout(std::int32_t tables, std::int32_t price)
+    : _tables_count(tables)
+    , _price(price)
+    , _tables(tables + 1) {}
+
+template <typename Layout>
+pc_club::basic_event_processor<Layout>::basic_event_processor(
     std::int32_t tables,
     std::int32_t price,
     std::int32_t open_time,
-    std::int32_t close_time
+    std::int32_t close_time,
+    std::ostream& out,
+    output_format format
 )
-    : _tables_count(tables)
-    , _price(price)
+    : _layout(tables, price)
     , _open_time(open_time)
     , _close_time(close_time)
-    , _tables(tables + 1, {.occupied_since = std::numeric_limits<std::int32_t>::max(), .revenue = 0, .usage = 0}) {
-  std::cout << format_time(open_time) << '\n';
+    , _clients(tables)
+    , _out(&out)
+    , _encoder(format) {
+  _encoder.open(_buffer, open_time);
+  flush();
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::write_event(
+    std::int32_t time,
+    std::int32_t id,
+    std::string_view name,
+    std::int32_t table_id
+) {
+  _encoder.event(_buffer, time, id, name, table_id);
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::write_error(std::int32_t time, std::string_view message) {
+  _errors++;
+  _encoder.event(_buffer, time, 13, message);
 }
 
-std::string pc_club::event_processor::format_time(std::int32_t minutes) {
-  std::int32_t h = minutes / 60;
-  std::int32_t m = minutes % 60;
-  char buf[6];
-  std::snprintf(buf, sizeof(buf), "%02d:%02d", h, m);
-  return buf;
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::flush() {
+  _out->write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+  _buffer.clear();
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::publish_seating(std::int32_t time) {
+  if (!_seating || !_seating_changed) {
+    return;
+  }
+  seating& next = _seating->prepare(_layout.tables_count());
+  for (std::int32_t i = 1; i <= _layout.tables_count(); i++) {
+    if (auto client = _clients.at_table(i); client != client_index::none) {
+      next.names[static_cast<std::size_t>(i - 1)].assign(_clients[client].name);
+    }
+  }
+  _seating->publish(time);
+  _seating_changed = false;
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::bill_table(std::int32_t table_id, std::int32_t current_time) {
+  table& t = _layout[table_id];
+  if (_journaling) {
+    _table_undo.emplace_back(table_id, t);
+  }
+  const client_record& client = _clients[_clients.at_table(table_id)];
+  std::int32_t duration = current_time - client.seated_since;
+  std::int64_t cost = _layout.bill(duration);
+  t.usage += duration;
+  t.revenue += cost;
+  if (_heatmap) {
+    // Only the opening hours are drawn: a table taken or left after the close time is clipped there.
+    _heatmap->record(table_id, std::max(client.seated_since, _open_time), std::min(current_time, _close_time));
+  }
+  if (_analytics) {
+    _analytics->record_session(client.name, duration, cost);
+  }
 }
 
-void pc_club::event_processor::close_table(std::int32_t table_id, std::int32_t current_time) {
-  std::int32_t start = _tables[table_id].occupied_since;
-  std::int32_t duration = current_time - start;
-  _tables[table_id].usage += duration;
-  const std::int32_t hours = (duration + 59) / 60;
-  _tables[table_id].revenue += static_cast<std::int64_t>(hours) * _price;
-  _client_table.erase_right(table_id);
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::close_table(std::int32_t table_id, std::int32_t current_time) {
+  bill_table(table_id, current_time);
+  _clients.unseat(table_id);
+  _seating_changed = true;
 }
 
-void pc_club::event_processor::assign_next(std::int32_t table_id, std::int32_t current_time) {
-  if (_waiting.empty()) {
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::assign_next(std::int32_t table_id, std::int32_t current_time) {
+  auto next = _clients.dequeue();
+  if (next == client_index::none) {
     return;
   }
-  std::string next = _waiting.front();
-  _waiting.pop();
-  _client_table.insert(next, table_id);
-  _tables[table_id].occupied_since = current_time;
-  std::cout << format_time(current_time) << " 12 " << next << ' ' << std::to_string(table_id) << '\n';
+  // A client who queued while already seated keeps their table, and this one stays free.
+  if (_clients.seat(next, table_id, current_time)) {
+    _seating_changed = true;
+  }
+  write_event(current_time, 12, _clients[next].name, table_id);
 }
 
-void pc_club::event_processor::enter(const event& e) {
-  std::cout << format_time(e.time) << " 1 " << e.name << '\n';
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::enter(const event& e) {
+  write_event(e.time, 1, e.name);
   if (e.time < _open_time) {
-    std::cout << format_time(e.time) << " 13 NotOpenYet\n";
-  } else if (!_clients.insert(e.name).second) {
-    std::cout << format_time(e.time) << " 13 YouShallNotPass\n";
+    write_error(e.time, "NotOpenYet");
+    return;
+  }
+  auto client = _clients.find_or_insert(e.name, name_hash(e));
+  if (_clients[client].present) {
+    write_error(e.time, "YouShallNotPass");
   } else {
-    _clients.insert(e.name);
+    _clients.set_present(client, true);
+    _peak_clients = std::max(_peak_clients, _clients.size());
   }
 }
 
-void pc_club::event_processor::take(const event& e) {
-  std::cout << format_time(e.time) << " 2 " << e.name << ' ' << std::to_string(e.table) << '\n';
-
-  if (!_clients.contains(e.name)) {
-    std::cout << format_time(e.time) << " 13 ClientUnknown\n";
-  } else if (_client_table.find_right(e.table) != _client_table.end_right()) {
-    std::cout << format_time(e.time) << " 13 PlaceIsBusy\n";
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::take(const event& e) {
+  write_event(e.time, 2, e.name, e.table);
+  auto client = _clients.find(e.name, name_hash(e));
+  if (client == client_index::none || !_clients[client].present) {
+    write_error(e.time, "ClientUnknown");
+  } else if (_clients.at_table(e.table) != client_index::none) {
+    write_error(e.time, "PlaceIsBusy");
   } else {
-    if (auto it = _client_table.find_left(e.name); it != _client_table.end_left()) {
-      std::int32_t old = *it.flip();
+    if (std::int32_t old = _clients[client].table; old != 0) {
       close_table(old, e.time);
       assign_next(old, e.time);
     }
-    _client_table.insert(e.name, e.table);
-    _tables[e.table].occupied_since = e.time;
+    // A client who was also first in the queue has just been called back to their old table.
+    if (_clients.seat(client, e.table, e.time)) {
+      _seating_changed = true;
+    }
   }
 }
 
-void pc_club::event_processor::wait(const event& e) {
-  std::cout << format_time(e.time) << " 3 " << e.name << '\n';
-  if (!_clients.contains(e.name)) {
-    std::cout << format_time(e.time) << " 13 ClientUnknown\n";
-  } else if (static_cast<std::int32_t>(_waiting.size()) >= _tables_count) {
-    std::cout << format_time(e.time) << " 11 " << e.name << '\n';
-  } else if (_client_table.size() == _tables_count) {
-    _waiting.emplace(e.name);
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::wait(const event& e) {
+  write_event(e.time, 3, e.name);
+  auto client = _clients.find(e.name, name_hash(e));
+  if (client == client_index::none || !_clients[client].present) {
+    write_error(e.time, "ClientUnknown");
+  } else if (_clients.queue_full()) {
+    write_event(e.time, 11, e.name);
+    _turn_aways++;
+    if (_analytics) {
+      _analytics->record_turn_away(e.name);
+    }
+  } else if (_clients.seated() == _layout.tables_count()) {
+    _clients.enqueue(client);
+    if (_analytics) {
+      _analytics->record_wait(e.name);
+    }
   } else {
-    std::cout << format_time(e.time) << " 13 ICanWaitNoLonger!\n";
+    write_error(e.time, "ICanWaitNoLonger!");
   }
 }
 
-void pc_club::event_processor::leave(const event& e) {
-  std::cout << format_time(e.time) << " 4 " << e.name << '\n';
-  if (!_clients.contains(e.name)) {
-    std::cout << format_time(e.time) << " 13 ClientUnknown\n";
-  } else {
-    if (auto it = _client_table.find_left(e.name); it != _client_table.end_left()) {
-      std::int32_t tbl = *it.flip();
-      close_table(tbl, e.time);
-      assign_next(tbl, e.time);
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::leave(const event& e) {
+  write_event(e.time, 4, e.name);
+  auto client = _clients.find(e.name, name_hash(e));
+  if (client == client_index::none || !_clients[client].present) {
+    write_error(e.time, "ClientUnknown");
+    return;
+  }
+  _clients.set_present(client, false);
+  if (std::int32_t tbl = _clients[client].table; tbl != 0) {
+    close_table(tbl, e.time);
+    assign_next(tbl, e.time);
+  }
+  // Kept while the client is still queued, or was just called to the freed table.
+  _clients.release(client);
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::retract(const event& e) {
+  _encoder.retraction(_buffer, e.time, e.name, e.target_time);
+  // The history is in time order, so the search stops at the first earlier event.
+  std::size_t found = _history_size;
+  for (std::size_t i = _history_size; i-- > 0 && _history[i].time >= e.target_time;) {
+    if (_history[i].time == e.target_time && _history[i].name == e.name) {
+      found = i;
+      break;
     }
-    _clients.erase(e.name);
   }
+  if (found == _history_size) {
+    _retraction_errors++;
+    write_error(e.time, "NothingToRetract");
+    return;
+  }
+
+  const journal_mark mark = _marks[found];
+  _clients.undo(mark.clients);
+  for (; _table_undo.size() > mark.tables; _table_undo.pop_back()) {
+    _layout[_table_undo.back().first] = _table_undo.back().second;
+  }
+  _turn_aways = mark.turn_aways;
+  _errors = mark.errors + (_retraction_errors - mark.retraction_errors);
+  _seating_changed = true;
+  const std::size_t end = _history_size;
+  _history_size = found;
+  _marks.resize(found);
+
+  // The replay only rebuilds the state: the output of these events was written when they came. Each
+  // replayed event is journaled one slot before its own, so it is read before anything overwrites it
+  // and the history does not grow while it is being read.
+  output_encoder encoder = std::exchange(_encoder, output_encoder(output_format::none));
+  client_analytics* analytics = std::exchange(_analytics, nullptr);
+  occupancy_heatmap* heatmap = std::exchange(_heatmap, nullptr);
+  for (std::size_t i = found + 1; i < end; i++) {
+    dispatch(_history[i]);
+  }
+  _encoder = encoder;
+  _analytics = analytics;
+  _heatmap = heatmap;
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::clear_journal() {
+  _history_size = 0;
+  _marks.clear();
+  _table_undo.clear();
+  _retraction_errors = 0;
+  _clients.commit();
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::set_journal(bool enabled) {
+  _journaling = enabled;
+  _clients.set_journaling(enabled);
+  clear_journal();
 }
 
-void pc_club::event_processor::process_event(const event& e) {
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::dispatch(const event& e) {
+  if (_journaling && e.type != event_type::retract) {
+    _marks.push_back({
+        .clients = _clients.journal_size(),
+        .tables = _table_undo.size(),
+        .turn_aways = _turn_aways,
+        .errors = _errors,
+        .retraction_errors = _retraction_errors
+    });
+    if (_history_size == _history.size()) {
+      _history.push_back(e);
+    } else {
+      // Copy-assignment reuses the name's buffer of an earlier event.
+      _history[_history_size] = e;
+    }
+    _history_size++;
+  }
   switch (e.type) {
   case event_type::enter:
     enter(e);
@@ -117,18 +276,187 @@ void pc_club::event_processor::process_event(const event& e) {
   case event_type::leave:
     leave(e);
     break;
+  case event_type::retract:
+    retract(e);
+    break;
   default:
     break;
   }
 }
 
-void pc_club::event_processor::close() {
-  for (auto it = _client_table.begin_left(); it != _client_table.end_left();) {
-    auto prev = it++;
-    close_table(*prev.flip(), _close_time);
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::prefetch(const event& e) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(e.name.data());
+  if (e.name_hash != 0) {
+    _clients.prefetch(e.name_hash);
+  }
+  if (e.table > 0 && e.table <= _layout.tables_count()) {
+    __builtin_prefetch(&_layout[e.table], 1);
+  }
+#else
+  (void)e;
+#endif
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::process_event(const event& e) {
+  dispatch(e);
+  flush();
+  publish_seating(e.time);
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::process_events(std::span<const event> events) {
+  // A few events ahead is enough to hide the misses on names and table records behind the current event's work.
+  constexpr std::size_t distance = 4;
+  // Long batches are written in cache-sized pieces rather than growing one large buffer.
+  constexpr std::size_t flush_threshold = 1 << 16;
+  for (std::size_t i = 0; i < events.size(); i++) {
+    if (i + distance < events.size()) {
+      prefetch(events[i + distance]);
+    }
+    dispatch(events[i]);
+    if (_buffer.size() >= flush_threshold) {
+      flush();
+    }
+  }
+  flush();
+  if (!events.empty()) {
+    publish_seating(events.back().time);
+  }
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::close() {
+  for (std::int32_t i = 1; i <= _layout.tables_count(); i++) {
+    if (_clients.at_table(i) != client_index::none) {
+      close_table(i, _close_time);
+    }
+  }
+  if (_heatmap) {
+    _heatmap->finish();
+  }
+  _encoder.close(_buffer, _close_time);
+  for (std::int32_t i = 1; i <= _layout.tables_count(); i++) {
+    _encoder.table(_buffer, i, _layout[i].revenue, _layout[i].usage);
+  }
+  flush();
+  clear_journal();
+  compact();
+  publish_seating(_close_time);
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::compact() {
+  // Clients whose leave event never came would otherwise stay for good in a feed spanning many days.
+  _clients.clear();
+  _clients.compact(_peak_clients);
+  _peak_clients = 0;
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::begin_day(std::int32_t open_time, std::int32_t close_time) {
+  // Already compacted by `close`; this only drops what a day that was not closed left behind.
+  _clients.clear();
+  clear_journal();
+  _seating_changed = true;
+  for (std::int32_t i = 1; i <= _layout.tables_count(); i++) {
+    _layout[i] = table{};
+  }
+  _turn_aways = 0;
+  _errors = 0;
+  _open_time = open_time;
+  _close_time = close_time;
+  _encoder.open(_buffer, open_time);
+  flush();
+  publish_seating(open_time);
+}
+
+template <typename Layout>
+pc_club::day_totals pc_club::basic_event_processor<Layout>::totals() const {
+  day_totals totals{.revenue = 0, .usage = 0, .turn_aways = _turn_aways, .errors = _errors};
+  for (std::int32_t i = 1; i <= _layout.tables_count(); i++) {
+    totals.revenue += _layout[i].revenue;
+    totals.usage += _layout[i].usage;
+  }
+  return totals;
+}
+
+template <typename Layout>
+pc_club::processor_memory pc_club::basic_event_processor<Layout>::memory_report() const {
+  auto clients = _clients.memory();
+  return {
+      .client_records = clients.records,
+      .client_names = clients.names,
+      .name_index = clients.name_index,
+      .table_index = clients.table_index,
+      .queue = clients.queue,
+      .tables = _layout.memory(),
+      .output_buffer = _buffer.capacity()
+  };
+}
+
+template <typename Layout>
+pc_club::processor_state pc_club::basic_event_processor<Layout>::snapshot() const {
+  processor_state state;
+  state.tables.reserve(static_cast<std::size_t>(_layout.tables_count()));
+  for (std::int32_t i = 1; i <= _layout.tables_count(); i++) {
+    state.tables.push_back(_layout[i]);
+    if (auto client = _clients.at_table(i); client != client_index::none) {
+      state.seated.push_back({.name = _clients[client].name, .table = i, .since = _clients[client].seated_since});
+    }
   }
-  std::cout << format_time(_close_time) << '\n';
-  for (std::int32_t i = 1; i <= _tables_count; i++) {
-    std::cout << i << ' ' << _tables[i].revenue << ' ' << format_time(_tables[i].usage) << '\n';
+  _clients.for_each([&](const client_record& client) {
+    if (client.present) {
+      state.clients.push_back(client.name);
+    }
+  });
+  _clients.for_each_queued([&](const client_record& client) { state.waiting.push_back(client.name); });
+  state.turn_aways = _turn_aways;
+  state.errors = _errors;
+  return state;
+}
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::restore(const processor_state& state) {
+  if (static_cast<std::int32_t>(state.tables.size()) != _layout.tables_count() ||
+      state.waiting.size() > static_cast<std::size_t>(_layout.tables_count())) {
+    throw std::invalid_argument("restore: the snapshot is of a different club");
+  }
+  for (std::int32_t i = 1; i <= _layout.tables_count(); i++) {
+    _layout[i] = state.tables[static_cast<std::size_t>(i - 1)];
+  }
+  _clients.clear();
+  for (const std::string& name : state.clients) {
+    _clients.set_present(_clients.find_or_insert(name, hash_name(name)), true);
+  }
+  for (const std::string& name : state.waiting) {
+    _clients.enqueue(_clients.find_or_insert(name, hash_name(name)));
   }
+  for (const processor_state::seat& s : state.seated) {
+    if (s.table < 1 || s.table > _layout.tables_count() || _clients.at_table(s.table) != client_index::none ||
+        !_clients.seat(_clients.find_or_insert(s.name, hash_name(s.name)), s.table, s.since)) {
+      throw std::invalid_argument("restore: the snapshot seats a table or a client twice");
+    }
+  }
+  _peak_clients = _clients.size();
+  _seating_changed = true;
+  _turn_aways = state.turn_aways;
+  _errors = state.errors;
+  // Events before the snapshot are not in the history, so they cannot be retracted.
+  clear_journal();
 }
+
+template <typename Layout>
+void pc_club::basic_event_processor<Layout>::set_output(std::ostream& out, output_format format) {
+  flush();
+  _out = &out;
+  _encoder = output_encoder(format);
+}
+
+template class pc_club::basic_event_processor<pc_club::dynamic_layout>;
+template class pc_club::basic_event_processor<pc_club::fixed_layout<3, 10>>;
+template class pc_club::basic_event_processor<pc_club::fixed_layout<5, 100>>;
+template class pc_club::basic_event_processor<pc_club::fixed_layout<10, 100>>;
+template class pc_club::basic_event_processor<pc_club::fixed_layout<20, 100>>;
@@ -0,0 +1,124 @@
+#include "event_source.h"
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <queue>
+#include <sstream>
+#include <utility>
+
+pc_club::line_source pc_club::read_lines(std::istream& in) {
+  std::string line;
+  while (std::getline(in, line)) {
+    co_yield std::string_view(line);
+  }
+}
+
+pc_club::line_source pc_club::read_file_lines(std::string path) {
+  if (path == "-") {
+    for (std::string_view line : read_lines(std::cin)) {
+      co_yield line;
+    }
+    co_return;
+  }
+  std::ifstream in(path);
+  for (std::string_view line : read_lines(in)) {
+    co_yield line;
+  }
+}
+
+pc_club::line_source pc_club::read_buffer_lines(std::string_view buffer) {
+  while (!buffer.empty()) {
+    std::size_t end = buffer.find('\n');
+    if (end == std::string_view::npos) {
+      co_yield buffer;
+      co_return;
+    }
+    co_yield buffer.substr(0, end);
+    buffer.remove_prefix(end + 1);
+  }
+}
+
+std::string pc_club::read_file_contents(const std::string& path) {
+  if (path == "-") {
+    return std::string(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+  }
+  std::ifstream in(path, std::ios::binary);
+  std::ostringstream contents;
+  contents << in.rdbuf();
+  return std::move(contents).str();
+}
+
+bool pc_club::read_parameters(line_source& lines, club_parameters& parameters, std::string& bad_line) {
+  auto next_line = [&lines, &bad_line] {
+    bad_line = lines.next() ? lines.value() : std::string_view();
+  };
+  next_line();
+  if (!parse_tables(bad_line, parameters.tables)) {
+    return false;
+  }
+  next_line();
+  if (!parse_hours(bad_line, parameters.open_time, parameters.close_time)) {
+    return false;
+  }
+  next_line();
+  if (!parse_price(bad_line, parameters.price)) {
+    return false;
+  }
+  bad_line.clear();
+  return true;
+}
+
+bool pc_club::read_parameters(std::string_view& buffer, club_parameters& parameters, std::string& bad_line) {
+  auto lines = read_buffer_lines(buffer);
+  if (!read_parameters(lines, parameters, bad_line)) {
+    return false;
+  }
+  // Drop the three header lines, each with its terminating '\n' if present.
+  for (int i = 0; i < 3; i++) {
+    std::size_t end = buffer.find('\n');
+    buffer.remove_prefix(end == std::string_view::npos ? buffer.size() : end + 1);
+  }
+  return true;
+}
+
+pc_club::generator<pc_club::event> pc_club::parse_events(
+    line_source& lines,
+    std::int32_t tables,
+    std::optional<std::string>& bad_line,
+    bool corrections
+) {
+  event e{};
+  while (lines.next()) {
+    if (!parse_event(lines.value(), tables, e, corrections)) {
+      bad_line.emplace(lines.value());
+      co_return;
+    }
+    co_yield e;
+  }
+}
+
+pc_club::generator<pc_club::event>
+pc_club::merge_events(std::vector<generator<event>>& sources, const std::optional<std::string>& bad_line) {
+  // (time, source) of every source's pending event; the event itself stays in the source's frame.
+  using head = std::pair<std::int32_t, std::size_t>;
+  std::priority_queue<head, std::vector<head>, std::greater<>> heads;
+  for (std::size_t i = 0; i < sources.size(); i++) {
+    if (sources[i].next()) {
+      heads.emplace(sources[i].value().time, i);
+    } else if (bad_line) {
+      co_return;
+    }
+  }
+  while (!heads.empty()) {
+    std::size_t i = heads.top().second;
+    heads.pop();
+    co_yield sources[i].value();
+    if (sources[i].next()) {
+      heads.emplace(sources[i].value().time, i);
+    } else if (bad_line) {
+      co_return;
+    }
+  }
+}
@@ -0,0 +1,165 @@
+#include "follow_source.h"
+
+#include <algorithm>
+#include <ctime>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+std::chrono::system_clock::time_point pc_club::today_at(std::int32_t minutes) {
+  std::time_t now = std::time(nullptr);
+  std::tm local{};
+#ifdef _WIN32
+  localtime_s(&local, &now);
+#else
+  localtime_r(&now, &local);
+#endif
+  local.tm_hour = minutes / 60;
+  local.tm_min = minutes % 60;
+  local.tm_sec = 0;
+  local.tm_isdst = -1;
+  return std::chrono::system_clock::from_time_t(std::mktime(&local));
+}
+
+#ifdef __linux__
+namespace {
+class file_descriptor {
+public:
+  explicit file_descriptor(int fd)
+      : _fd(fd) {}
+
+  file_descriptor(const file_descriptor&) = delete;
+  file_descriptor& operator=(const file_descriptor&) = delete;
+
+  ~file_descriptor() {
+    if (_fd >= 0) {
+      ::close(_fd);
+    }
+  }
+
+  int get() const {
+    return _fd;
+  }
+
+private:
+  int _fd;
+};
+
+// Milliseconds until the deadline for poll(): -1 waits forever, 0 means it has passed.
+int poll_timeout(const pc_club::follow_options& options) {
+  if (!options.deadline) {
+    return -1;
+  }
+  auto left = std::chrono::ceil<std::chrono::milliseconds>(*options.deadline - std::chrono::system_clock::now());
+  return left.count() <= 0 ? 0 : static_cast<int>(std::min<std::int64_t>(left.count(), 1 << 30));
+}
+
+enum class wait_result {
+  ready,
+  timeout,
+  finished
+};
+
+wait_result wait_readable(int fd, const pc_club::follow_options& options) {
+  for (;;) {
+    int timeout = poll_timeout(options);
+    if (timeout == 0) {
+      return wait_result::timeout;
+    }
+    pollfd p{.fd = fd, .events = POLLIN, .revents = 0};
+    int r = ::poll(&p, 1, timeout);
+    if (r > 0) {
+      return wait_result::ready;
+    }
+    if (r == 0) {
+      return wait_result::timeout;
+    }
+    if (errno != EINTR) {
+      return wait_result::finished;
+    }
+  }
+}
+
+// Drains pending inotify events; false if the followed file was renamed or unlinked. An open file
+// never reports IN_DELETE_SELF, so unlinking is detected through its link count.
+bool still_watched(int watch_fd, int file_fd) {
+  alignas(inotify_event) char buf[4096];
+  bool moved = false;
+  for (ssize_t n; (n = ::read(watch_fd, buf, sizeof(buf))) > 0;) {
+    for (ssize_t offset = 0; offset < n;) {
+      const auto* ev = reinterpret_cast<const inotify_event*>(buf + offset);
+      moved = moved || (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) != 0;
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+    }
+  }
+  struct stat st{};
+  return !moved && ::fstat(file_fd, &st) == 0 && st.st_nlink > 0;
+}
+} // namespace
+
+pc_club::line_source pc_club::follow_file_lines(std::string path, const follow_options& options) {
+  // "-" follows stdin like `read_file_lines` reads it; a duplicate keeps fd 0 open after the source ends.
+  const bool from_stdin = path == "-";
+  file_descriptor file(from_stdin ? ::fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 0) : ::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (file.get() < 0) {
+    co_return;
+  }
+  struct stat st{};
+  ::fstat(file.get(), &st);
+  // Stdin has no path to watch, so it is polled like a FIFO whatever it is connected to.
+  const bool fifo = from_stdin || S_ISFIFO(st.st_mode);
+
+  file_descriptor watch(fifo ? -1 : ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+  if (!fifo && (watch.get() < 0 || ::inotify_add_watch(watch.get(), path.c_str(), IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF) < 0)) {
+    co_return;
+  }
+
+  std::string pending;
+  char buf[1 << 16];
+  bool watched = true;
+  for (;;) {
+    if (fifo && wait_readable(file.get(), options) != wait_result::ready) {
+      break;
+    }
+    ssize_t n = ::read(file.get(), buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n > 0) {
+      pending.append(buf, static_cast<std::size_t>(n));
+      std::size_t begin = 0;
+      for (std::size_t end; (end = pending.find('\n', begin)) != std::string::npos; begin = end + 1) {
+        co_yield std::string_view(pending).substr(begin, end - begin);
+      }
+      pending.erase(0, begin);
+      continue;
+    }
+    // End of the data written so far: a FIFO without writers is done, a file waits for more.
+    if (fifo || n < 0 || !watched) {
+      break;
+    }
+    if (wait_readable(watch.get(), options) != wait_result::ready) {
+      break;
+    }
+    // A removed file may still have unread data, so read once more before stopping.
+    watched = still_watched(watch.get(), file.get());
+  }
+  if (!pending.empty()) {
+    co_yield std::string_view(pending);
+  }
+}
+#else
+// Without inotify the file is read once, as by `read_file_lines`.
+pc_club::line_source pc_club::follow_file_lines(std::string path, const follow_options&) {
+  for (std::string_view line : read_file_lines(std::move(path))) {
+    co_yield line;
+  }
+}
+#endif
@@ -0,0 +1,78 @@
+#include "occupancy_heatmap.h"
+
+#include <stdexcept>
+#include <string>
+
+pc_club::occupancy_heatmap::occupancy_heatmap(std::int32_t tables)
+    : _tables(tables)
+    , _row(static_cast<std::size_t>(tables)) {
+  if (tables <= 0) {
+    throw std::invalid_argument("occupancy_heatmap: the club needs at least one table");
+  }
+  _diff.resize((minutes + 1) * _row);
+  _counts.resize(minutes * _row);
+  _club.resize(minutes);
+}
+
+void pc_club::occupancy_heatmap::finish() {
+  const std::int32_t* diff = _diff.data();
+  std::int32_t* counts = _counts.data();
+  for (std::size_t t = 0; t < _row; t++) {
+    counts[t] = diff[t];
+  }
+  for (std::size_t m = 1; m < minutes; m++) {
+    const std::int32_t* prev = counts + (m - 1) * _row;
+    const std::int32_t* d = diff + m * _row;
+    std::int32_t* row = counts + m * _row;
+    for (std::size_t t = 0; t < _row; t++) {
+      row[t] = prev[t] + d[t];
+    }
+  }
+  for (std::size_t m = 0; m < minutes; m++) {
+    const std::int32_t* row = counts + m * _row;
+    std::int32_t sum = 0;
+    for (std::size_t t = 0; t < _row; t++) {
+      sum += row[t];
+    }
+    _club[m] = sum;
+  }
+}
+
+void pc_club::occupancy_heatmap::write_csv(std::ostream& out) const {
+  std::string text = "minute,club";
+  for (std::int32_t t = 1; t <= _tables; t++) {
+    text += ',';
+    text += std::to_string(t);
+  }
+  text += '\n';
+  for (std::int32_t m = 0; m < minutes; m++) {
+    text += std::to_string(m);
+    text += ',';
+    text += std::to_string(club(m));
+    for (std::int32_t t = 1; t <= _tables; t++) {
+      text += ',';
+      text += std::to_string(occupancy(t, m));
+    }
+    text += '\n';
+  }
+  out << text;
+}
+
+void pc_club::occupancy_heatmap::write_binary(std::ostream& out) const {
+  std::string bytes;
+  bytes.reserve((1 + minutes * (_row + 1)) * sizeof(std::int32_t));
+  auto put = [&bytes](std::int32_t value) {
+    auto u = static_cast<std::uint32_t>(value);
+    for (int i = 0; i < 4; i++) {
+      bytes += static_cast<char>(u >> (8 * i) & 0xFF);
+    }
+  };
+  put(_tables);
+  for (std::int32_t m = 0; m < minutes; m++) {
+    put(club(m));
+    for (std::int32_t t = 1; t <= _tables; t++) {
+      put(occupancy(t, m));
+    }
+  }
+  out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
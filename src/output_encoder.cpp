@@ -0,0 +1,314 @@
+#include "output_encoder.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+const char* record_name(pc_club::record_kind kind) {
+  switch (kind) {
+  case pc_club::record_kind::open:
+    return "open";
+  case pc_club::record_kind::event:
+    return "event";
+  case pc_club::record_kind::close:
+    return "close";
+  case pc_club::record_kind::table:
+    return "table";
+  case pc_club::record_kind::input_error:
+    return "input_error";
+  default:
+    return "continuation";
+  }
+}
+
+void append_number(std::string& out, std::int64_t value) {
+  char buf[24];
+  out.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+}
+
+// printf's %02d: a single digit gets a leading zero, a negative value keeps its sign unpadded.
+void append_two_digits(std::string& out, std::int32_t value) {
+  if (value >= 0 && value < 10) {
+    out += '0';
+  }
+  append_number(out, value);
+}
+
+// HH:MM; hours are not wrapped, so durations of a day or more stay readable. A negative duration (an
+// event after the close time) prints each field with its own sign, and like "%02d:%02d" into a six-byte
+// buffer the result is cut to five characters.
+void append_time(std::string& out, std::int32_t minutes) {
+  const std::size_t start = out.size();
+  append_two_digits(out, minutes / 60);
+  out += ':';
+  append_two_digits(out, minutes % 60);
+  out.resize(std::min(out.size(), start + 5));
+}
+
+void append_csv_field(std::string& out, std::string_view value) {
+  if (value.find_first_of(",\"\r\n") == std::string_view::npos) {
+    out += value;
+    return;
+  }
+  out += '"';
+  for (char c : value) {
+    if (c == '"') {
+      out += '"';
+    }
+    out += c;
+  }
+  out += '"';
+}
+
+void append_json_string(std::string& out, std::string_view value) {
+  constexpr char hex[] = "0123456789abcdef";
+  out += '"';
+  for (char c : value) {
+    auto u = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (u < 0x20) {
+      out += "\\u00";
+      out += hex[u >> 4];
+      out += hex[u & 0xf];
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+template <typename T>
+void store_le(char* at, T value) {
+  auto bits = static_cast<std::make_unsigned_t<T>>(value);
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    at[i] = static_cast<char>(bits >> (8 * i) & 0xff);
+  }
+}
+} // namespace
+
+bool pc_club::parse_output_format(std::string_view name, output_format& format) {
+  if (name == "text") {
+    format = output_format::text;
+  } else if (name == "csv") {
+    format = output_format::csv;
+  } else if (name == "jsonl") {
+    format = output_format::jsonl;
+  } else if (name == "binary") {
+    format = output_format::binary;
+  } else if (name == "none") {
+    format = output_format::none;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::span<const pc_club::binary_record> pc_club::binary_records(std::span<const std::byte> bytes) {
+  return {reinterpret_cast<const binary_record*>(bytes.data()), bytes.size() / sizeof(binary_record)};
+}
+
+pc_club::output_encoder::output_encoder(output_format format)
+    : _format(format) {}
+
+void pc_club::output_encoder::begin(std::string& out) const {
+  if (_format == output_format::csv) {
+    out += "record,time,id,name,table,revenue,usage\n";
+  }
+}
+
+void pc_club::output_encoder::open(std::string& out, std::int32_t time) const {
+  if (_format == output_format::text) {
+    append_time(out, time);
+    out += '\n';
+    return;
+  }
+  _record(out, record_kind::open, time, 0, {}, 0, 0, 0);
+}
+
+void pc_club::output_encoder::event(
+    std::string& out,
+    std::int32_t time,
+    std::int32_t id,
+    std::string_view name,
+    std::int32_t table
+) const {
+  if (_format == output_format::text) {
+    append_time(out, time);
+    out += ' ';
+    append_number(out, id);
+    out += ' ';
+    out += name;
+    if (table != 0) {
+      out += ' ';
+      append_number(out, table);
+    }
+    out += '\n';
+    return;
+  }
+  _record(out, record_kind::event, time, id, name, table, 0, 0);
+}
+
+void pc_club::output_encoder::retraction(
+    std::string& out,
+    std::int32_t time,
+    std::string_view name,
+    std::int32_t target_time
+) const {
+  if (_format == output_format::text) {
+    append_time(out, time);
+    out += " 5 ";
+    out += name;
+    out += ' ';
+    append_time(out, target_time);
+    out += '\n';
+    return;
+  }
+  _record(out, record_kind::event, time, 5, name, 0, 0, target_time);
+}
+
+void pc_club::output_encoder::close(std::string& out, std::int32_t time) const {
+  if (_format == output_format::text) {
+    append_time(out, time);
+    out += '\n';
+    return;
+  }
+  _record(out, record_kind::close, time, 0, {}, 0, 0, 0);
+}
+
+void pc_club::output_encoder::table(std::string& out, std::int32_t table_id, std::int64_t revenue, std::int32_t usage)
+    const {
+  if (_format == output_format::text) {
+    append_number(out, table_id);
+    out += ' ';
+    append_number(out, revenue);
+    out += ' ';
+    append_time(out, usage);
+    out += '\n';
+    return;
+  }
+  _record(out, record_kind::table, 0, 0, {}, table_id, revenue, usage);
+}
+
+void pc_club::output_encoder::input_error(std::string& out, std::string_view line) const {
+  if (_format == output_format::text) {
+    out += line;
+    out += '\n';
+    return;
+  }
+  _record(out, record_kind::input_error, 0, 0, line, 0, 0, 0);
+}
+
+void pc_club::output_encoder::_record(
+    std::string& out,
+    record_kind kind,
+    std::int32_t time,
+    std::int32_t id,
+    std::string_view name,
+    std::int32_t table,
+    std::int64_t revenue,
+    std::int32_t usage
+) const {
+  const bool timed = kind == record_kind::open || kind == record_kind::event || kind == record_kind::close;
+  const bool named = kind == record_kind::event || kind == record_kind::input_error;
+  const bool summary = kind == record_kind::table;
+  const bool retraction = kind == record_kind::event && id == 5;
+
+  switch (_format) {
+  case output_format::csv:
+    out += record_name(kind);
+    out += ',';
+    if (timed) {
+      append_number(out, time);
+    }
+    out += ',';
+    if (kind == record_kind::event) {
+      append_number(out, id);
+    }
+    out += ',';
+    if (named) {
+      append_csv_field(out, name);
+    }
+    out += ',';
+    if (table != 0) {
+      append_number(out, table);
+    }
+    out += ',';
+    if (summary) {
+      append_number(out, revenue);
+      out += ',';
+      append_number(out, usage);
+    } else {
+      out += ',';
+      if (retraction) {
+        append_number(out, usage);
+      }
+    }
+    out += '\n';
+    break;
+  case output_format::jsonl:
+    out += R"({"record":")";
+    out += record_name(kind);
+    out += '"';
+    if (timed) {
+      out += R"(,"time":)";
+      append_number(out, time);
+    }
+    if (kind == record_kind::event) {
+      out += R"(,"id":)";
+      append_number(out, id);
+      out += R"(,"name":)";
+      append_json_string(out, name);
+    } else if (kind == record_kind::input_error) {
+      out += R"(,"line":)";
+      append_json_string(out, name);
+    }
+    if (table != 0) {
+      out += R"(,"table":)";
+      append_number(out, table);
+    }
+    if (retraction) {
+      out += R"(,"target_time":)";
+      append_number(out, usage);
+    }
+    if (summary) {
+      out += R"(,"revenue":)";
+      append_number(out, revenue);
+      out += R"(,"usage":)";
+      append_number(out, usage);
+    }
+    out += "}\n";
+    break;
+  case output_format::binary: {
+    char record[sizeof(binary_record)] = {};
+    record[offsetof(binary_record, kind)] = static_cast<char>(kind);
+    record[offsetof(binary_record, id)] = static_cast<char>(id);
+    store_le(record + offsetof(binary_record, name_size), static_cast<std::uint32_t>(name.size()));
+    store_le(record + offsetof(binary_record, time), time);
+    store_le(record + offsetof(binary_record, table), table);
+    store_le(record + offsetof(binary_record, usage), usage);
+    store_le(record + offsetof(binary_record, revenue), revenue);
+    std::size_t chunk = std::min(name.size(), binary_record::inline_name);
+    // An empty name may have no data pointer at all, which memcpy does not accept even for no bytes.
+    if (chunk != 0) {
+      std::memcpy(record + offsetof(binary_record, name), name.data(), chunk);
+    }
+    out.append(record, sizeof(record));
+    for (name.remove_prefix(chunk); !name.empty(); name.remove_prefix(chunk)) {
+      char continuation[sizeof(binary_record)] = {};
+      continuation[offsetof(binary_record, kind)] = static_cast<char>(record_kind::continuation);
+      chunk = std::min(name.size(), binary_record::inline_name);
+      store_le(continuation + offsetof(binary_record, name_size), static_cast<std::uint32_t>(chunk));
+      std::memcpy(continuation + offsetof(binary_record, name), name.data(), chunk);
+      out.append(continuation, sizeof(continuation));
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
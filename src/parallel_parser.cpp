@@ -0,0 +1,96 @@
+#include "parallel_parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+namespace {
+struct chunk {
+  std::string_view text;
+  std::vector<pc_club::event> events;
+  std::optional<std::string_view> bad_line;
+};
+
+// Parses lines until the chunk ends, it fails, or an earlier chunk is known to have failed (its line
+// would be reported instead, so the rest of this one is irrelevant).
+void parse_chunk(
+    chunk& c,
+    std::size_t index,
+    std::int32_t tables,
+    bool corrections,
+    std::atomic<std::size_t>& first_failed
+) {
+  pc_club::event e{};
+  std::string_view text = c.text;
+  while (!text.empty()) {
+    if (first_failed.load(std::memory_order_relaxed) < index) {
+      return;
+    }
+    std::size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    if (!pc_club::parse_event(line, tables, e, corrections)) {
+      c.bad_line = line;
+      std::size_t seen = first_failed.load();
+      while (index < seen && !first_failed.compare_exchange_weak(seen, index)) {
+      }
+      return;
+    }
+    c.events.push_back(e);
+  }
+}
+
+// Cuts `section` into at most `count` pieces of similar size, each ending just after a '\n'.
+std::vector<chunk> split(std::string_view section, std::size_t count) {
+  std::vector<chunk> chunks;
+  const std::size_t step = section.size() / count + 1;
+  while (!section.empty()) {
+    std::size_t end = section.find('\n', std::min(step, section.size()) - 1);
+    end = end == std::string_view::npos ? section.size() : end + 1;
+    chunks.push_back({.text = section.substr(0, end), .events = {}, .bad_line = std::nullopt});
+    section.remove_prefix(end);
+  }
+  return chunks;
+}
+} // namespace
+
+std::vector<pc_club::event> pc_club::parse_events_parallel(
+    std::string_view section,
+    std::int32_t tables,
+    std::optional<std::string>& bad_line,
+    const parallel_parse_options& options
+) {
+  std::size_t threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+  threads = std::clamp<std::size_t>(section.size() / std::max<std::size_t>(options.min_chunk, 1), 1, threads);
+
+  std::vector<chunk> chunks = split(section, threads);
+  std::atomic<std::size_t> first_failed = chunks.size();
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(chunks.size());
+    for (std::size_t i = 1; i < chunks.size(); i++) {
+      workers.emplace_back([&, i] {
+        parse_chunk(chunks[i], i, tables, options.corrections, first_failed);
+      });
+    }
+    if (!chunks.empty()) {
+      parse_chunk(chunks[0], 0, tables, options.corrections, first_failed);
+    }
+  }
+
+  const std::size_t used = std::min(first_failed.load() + 1, chunks.size());
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < used; i++) {
+    total += chunks[i].events.size();
+  }
+  std::vector<event> events;
+  events.reserve(total);
+  for (std::size_t i = 0; i < used; i++) {
+    std::move(chunks[i].events.begin(), chunks[i].events.end(), std::back_inserter(events));
+  }
+  if (first_failed.load() < chunks.size()) {
+    bad_line.emplace(*chunks[first_failed.load()].bad_line);
+  }
+  return events;
+}
@@ -0,0 +1,75 @@
+#include "parallel_replay.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+void pc_club::replay_parallel(
+    std::span<const event> events,
+    const club_parameters& club,
+    std::ostream& out,
+    output_format format,
+    const parallel_replay_options& options
+) {
+  auto with_processor = [&](std::ostream& to, output_format to_format, auto&& f) {
+    with_event_processor(club.tables, club.price, club.open_time, club.close_time, to, to_format, f);
+  };
+  std::size_t threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t segments =
+      std::clamp<std::size_t>(events.size() / std::max<std::size_t>(options.min_segment, 1), 1, threads);
+  if (segments == 1) {
+    with_processor(out, format, [&](auto& ep) {
+      ep.process_events(events);
+      ep.close();
+    });
+    return;
+  }
+
+  // Segment i covers the events from bounds[i] up to bounds[i + 1].
+  std::vector<std::size_t> bounds(segments + 1);
+  for (std::size_t i = 0; i <= segments; i++) {
+    bounds[i] = events.size() * i / segments;
+  }
+  auto segment = [&](std::size_t i) {
+    return events.subspan(bounds[i], bounds[i + 1] - bounds[i]);
+  };
+
+  std::vector<processor_state> states(segments);
+  std::ostream discard(nullptr);
+  with_processor(discard, output_format::none, [&](auto& ep) {
+    for (std::size_t i = 1; i < segments; i++) {
+      ep.process_events(segment(i - 1));
+      states[i] = ep.snapshot();
+    }
+  });
+
+  std::vector<std::ostringstream> outputs(segments);
+  auto replay = [&](std::size_t i) {
+    // Only the first segment writes the opening record; the others resume mid-day from their snapshot.
+    std::ostream silent(nullptr);
+    std::ostream& to = i == 0 ? static_cast<std::ostream&>(outputs[i]) : silent;
+    with_processor(to, i == 0 ? format : output_format::none, [&](auto& ep) {
+      if (i > 0) {
+        ep.restore(states[i]);
+        ep.set_output(outputs[i], format);
+      }
+      ep.process_events(segment(i));
+      if (i + 1 == segments) {
+        ep.close();
+      }
+    });
+  };
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(segments - 1);
+    for (std::size_t i = 1; i < segments; i++) {
+      workers.emplace_back(replay, i);
+    }
+    replay(0);
+  }
+  for (const auto& output : outputs) {
+    std::string_view text = output.view();
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+  }
+}
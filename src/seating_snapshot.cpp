@@ -0,0 +1,32 @@
+#include "seating_snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+
+pc_club::seating& pc_club::seating_publisher::prepare(std::int32_t tables) {
+  // Neither published nor held by a reader: readers only get snapshots through `_current`, so nobody
+  // can start using it while it is refilled.
+  auto free = std::find_if(_pool.begin(), _pool.end(), [](const auto& s) { return s.use_count() == 1; });
+  if (free != _pool.end()) {
+    // Pairs with the release of the last reader's reference, so its reads are over before the writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    _next = *free;
+  } else {
+    _next = std::make_shared<seating>();
+    // With every pooled snapshot still in use, the extra one is left to the readers to reclaim.
+    if (_pool.size() < pool_size) {
+      _pool.push_back(_next);
+    }
+  }
+  _next->names.resize(static_cast<std::size_t>(tables));
+  for (std::string& name : _next->names) {
+    name.clear();
+  }
+  return *_next;
+}
+
+void pc_club::seating_publisher::publish(std::int32_t time) {
+  _next->version = ++_version;
+  _next->time = time;
+  _current.store(std::move(_next), std::memory_order_release);
+}
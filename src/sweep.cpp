@@ -0,0 +1,54 @@
+#include "sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+
+std::vector<pc_club::sweep_result> pc_club::run_sweep(
+    std::span<const event> events,
+    const club_parameters& club,
+    std::span<const sweep_config> configs,
+    unsigned threads
+) {
+  for (const sweep_config& config : configs) {
+    if (config.tables < club.tables || config.price <= 0) {
+      throw std::invalid_argument("run_sweep: configuration cannot replay the day");
+    }
+  }
+
+  std::vector<sweep_result> results(configs.size());
+  std::atomic<std::size_t> next = 0;
+  auto worker = [&] {
+    std::ostream discard(nullptr);
+    for (std::size_t i; (i = next++) < configs.size();) {
+      const sweep_config& config = configs[i];
+      results[i].config = config;
+      with_event_processor(
+          config.tables,
+          config.price,
+          club.open_time,
+          club.close_time,
+          discard,
+          output_format::none,
+          [&](auto& ep) {
+            ep.process_events(events);
+            ep.close();
+            results[i].totals = ep.totals();
+          }
+      );
+    }
+  };
+
+  std::size_t workers = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  workers = std::clamp<std::size_t>(workers, 1, std::max<std::size_t>(configs.size(), 1));
+  {
+    std::vector<std::jthread> pool;
+    for (std::size_t w = 1; w < workers; w++) {
+      pool.emplace_back(worker);
+    }
+    worker();
+  }
+  return results;
+}
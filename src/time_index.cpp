@@ -0,0 +1,181 @@
+#include "time_index.h"
+
+#include "event_parser.h"
+#include "event_source.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+constexpr std::string_view magic = "pc_club-index";
+constexpr int version = 2;
+
+bool expect(std::istream& in, std::string_view keyword) {
+  std::string word;
+  return in >> word && word == keyword;
+}
+
+template <typename T>
+bool read_count(std::istream& in, std::string_view keyword, T& count) {
+  return expect(in, keyword) && in >> count;
+}
+
+void write_names(std::ostream& out, std::string_view keyword, const std::vector<std::string>& names) {
+  out << keyword << ' ' << names.size();
+  for (const auto& name : names) {
+    out << ' ' << name;
+  }
+  out << '\n';
+}
+
+// The counts in an index file are not trusted: elements are appended as they are read, so a corrupt
+// count fails at the end of the file instead of sizing a buffer.
+bool read_names(std::istream& in, std::string_view keyword, std::vector<std::string>& names) {
+  std::size_t count = 0;
+  if (!read_count(in, keyword, count)) {
+    return false;
+  }
+  names.clear();
+  for (std::string name; names.size() < count; names.push_back(std::move(name))) {
+    if (!(in >> name)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool read_state(std::istream& in, pc_club::processor_state& state) {
+  std::size_t count = 0;
+  if (!read_count(in, "tables", count)) {
+    return false;
+  }
+  state.tables.clear();
+  for (pc_club::table t; state.tables.size() < count; state.tables.push_back(t)) {
+    if (!(in >> t.revenue >> t.usage)) {
+      return false;
+    }
+  }
+  if (!read_names(in, "clients", state.clients) || !read_names(in, "waiting", state.waiting) ||
+      !read_count(in, "seated", count)) {
+    return false;
+  }
+  state.seated.clear();
+  for (pc_club::processor_state::seat s{}; state.seated.size() < count; state.seated.push_back(std::move(s))) {
+    if (!(in >> s.name >> s.table >> s.since)) {
+      return false;
+    }
+  }
+  return expect(in, "counters") && in >> state.turn_aways >> state.errors;
+}
+
+bool read_bytes(std::istream& in, std::size_t size, std::string& out) {
+  out.clear();
+  char buffer[4096];
+  while (size > 0) {
+    std::size_t chunk = std::min(size, sizeof(buffer));
+    if (!in.read(buffer, static_cast<std::streamsize>(chunk))) {
+      return false;
+    }
+    out.append(buffer, chunk);
+    size -= chunk;
+  }
+  return true;
+}
+} // namespace
+
+const pc_club::checkpoint* pc_club::time_index::find(std::int32_t minute) const {
+  auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), minute, [](std::int32_t m, const checkpoint& c) {
+    return m < c.minute;
+  });
+  return it == checkpoints.begin() ? nullptr : &*std::prev(it);
+}
+
+std::string pc_club::index_path(const std::string& input_path) {
+  return input_path + ".idx";
+}
+
+bool pc_club::build_time_index(
+    std::string_view input,
+    std::int32_t interval,
+    time_index& index,
+    std::string& bad_line
+) {
+  std::string_view section = input;
+  club_parameters club{};
+  if (!read_parameters(section, club, bad_line)) {
+    return false;
+  }
+  index.input_size = input.size();
+  index.header = input.substr(0, input.size() - section.size());
+  index.checkpoints.clear();
+
+  std::ostream discard(nullptr);
+  event_processor processor(club.tables, club.price, club.open_time, club.close_time, discard, output_format::none);
+  event e{};
+  // Events are in time order, so every event before a checkpoint is earlier than its minute.
+  std::int32_t next = 0;
+  while (!section.empty()) {
+    std::size_t end = section.find('\n');
+    std::string_view line = section.substr(0, end);
+    if (!parse_event(line, club.tables, e)) {
+      bad_line.assign(line);
+      return false;
+    }
+    if (e.time >= next) {
+      auto offset = static_cast<std::uint64_t>(line.data() - input.data());
+      index.checkpoints.push_back({.minute = next, .offset = offset, .state = processor.snapshot()});
+      next = (e.time / interval + 1) * interval;
+    }
+    processor.process_event(e);
+    section.remove_prefix(end == std::string_view::npos ? section.size() : end + 1);
+  }
+  return true;
+}
+
+void pc_club::write_time_index(std::ostream& out, const time_index& index) {
+  out << magic << ' ' << version << '\n';
+  out << "input " << index.input_size << '\n';
+  out << "header " << index.header.size() << '\n' << index.header;
+  out << "checkpoints " << index.checkpoints.size() << '\n';
+  for (const checkpoint& c : index.checkpoints) {
+    out << "checkpoint " << c.minute << ' ' << c.offset << '\n';
+    out << "tables " << c.state.tables.size() << '\n';
+    for (const table& t : c.state.tables) {
+      out << t.revenue << ' ' << t.usage << '\n';
+    }
+    write_names(out, "clients", c.state.clients);
+    write_names(out, "waiting", c.state.waiting);
+    out << "seated " << c.state.seated.size();
+    for (const auto& [name, table_id, since] : c.state.seated) {
+      out << ' ' << name << ' ' << table_id << ' ' << since;
+    }
+    out << '\n';
+    out << "counters " << c.state.turn_aways << ' ' << c.state.errors << '\n';
+  }
+}
+
+std::optional<pc_club::time_index> pc_club::read_time_index(std::istream& in) {
+  time_index index;
+  int file_version = 0;
+  std::size_t header_size = 0;
+  if (!read_count(in, magic, file_version) || file_version != version || !read_count(in, "input", index.input_size) ||
+      !read_count(in, "header", header_size) || header_size > index.input_size || in.get() != '\n') {
+    return std::nullopt;
+  }
+  std::size_t count = 0;
+  if (!read_bytes(in, header_size, index.header) || !read_count(in, "checkpoints", count)) {
+    return std::nullopt;
+  }
+  for (checkpoint c{}; index.checkpoints.size() < count; index.checkpoints.push_back(std::move(c))) {
+    if (!read_count(in, "checkpoint", c.minute) || !(in >> c.offset) || !read_state(in, c.state)) {
+      return std::nullopt;
+    }
+    // `find` relies on the order, and a resumed replay seeks to the offset.
+    if (c.offset < header_size || c.offset > index.input_size ||
+        (!index.checkpoints.empty() &&
+         (c.minute < index.checkpoints.back().minute || c.offset < index.checkpoints.back().offset))) {
+      return std::nullopt;
+    }
+  }
+  return index;
+}
@@ -0,0 +1,51 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <fstream>
+
+pc_club::trace_recorder::trace_recorder(std::uint32_t sample_every)
+    : _origin(clock::now())
+    , _sample_every(std::max<std::uint32_t>(sample_every, 1))
+    , _sample_counter(0) {}
+
+void pc_club::trace_recorder::record(const char* name, clock::time_point start, clock::time_point end) {
+  _spans.push_back(
+      {.name = name,
+       .start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - _origin).count(),
+       .duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()}
+  );
+}
+
+bool pc_club::trace_recorder::sample() {
+  if (++_sample_counter < _sample_every) {
+    return false;
+  }
+  _sample_counter = 0;
+  return true;
+}
+
+bool pc_club::trace_recorder::write(const std::string& path) const {
+  std::ofstream out(path);
+  if (!out) {
+    return false;
+  }
+  // Chrome trace timestamps are in microseconds; keep nanosecond precision in the fraction.
+  auto micros = [&out](std::int64_t ns) {
+    out << ns / 1000 << '.' << static_cast<char>('0' + ns / 100 % 10) << static_cast<char>('0' + ns / 10 % 10)
+        << static_cast<char>('0' + ns % 10);
+  };
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  for (std::size_t i = 0; i < _spans.size(); i++) {
+    out << (i == 0 ? "\n" : ",\n") << R"({"name":")" << _spans[i].name << R"(","ph":"X","pid":1,"tid":1,"ts":)";
+    micros(_spans[i].start_ns);
+    out << ",\"dur\":";
+    micros(_spans[i].duration_ns);
+    out << '}';
+  }
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+}
+
+std::size_t pc_club::trace_recorder::size() const {
+  return _spans.size();
+}
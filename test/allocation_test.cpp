@@ -0,0 +1,291 @@
+#include "compact-bimap.h"
+#include "event_processor.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Counts every allocation made through the global operator new by this test binary, which is built
+// on its own so that the replacements do not reach the other tests. Every form is replaced, so memory
+// is never freed by a different allocator than the one that gave it out.
+#if defined(__GNUC__) && !defined(__clang__)
+// The replacements below pair malloc with free; GCC cannot see that through operator new.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> allocated_bytes{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return ::operator new(size);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+// Client records are cache-line aligned, so their storage comes through the aligned forms.
+void* operator new(std::size_t size, std::align_val_t align) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  auto alignment = static_cast<std::size_t>(align);
+  // aligned_alloc wants a non-zero multiple of the alignment.
+  std::size_t rounded = (size / alignment + 1) * alignment;
+  if (void* p = std::aligned_alloc(alignment, rounded)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+  return ::operator new(size, align);
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  try {
+    return ::operator new(size, align);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return ::operator new(size, align, std::nothrow);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+namespace {
+class null_buf : public std::streambuf {
+protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    return n;
+  }
+
+  int_type overflow(int_type c) override {
+    return c;
+  }
+};
+
+// One busy hour: more clients than tables arrive, sit down, switch tables, queue and leave. Names are
+// longer than the small-string buffer so that copying them would allocate.
+std::vector<pc_club::event> busy_hour(std::int32_t start, std::int32_t tables) {
+  using namespace pc_club;
+  std::vector<event> events;
+  auto name = [](std::int32_t i) {
+    return "regular_client_number_" + std::to_string(i);
+  };
+  const std::int32_t clients = tables + 2;
+  for (std::int32_t i = 0; i < clients; i++) {
+    events.push_back({.time = start, .type = event_type::enter, .name = name(i), .table = 0});
+    events.push_back({.time = start, .type = event_type::enter, .name = name(i), .table = 0});
+  }
+  events.push_back({.time = start + 1, .type = event_type::take, .name = name(0), .table = 1});
+  events.push_back({.time = start + 2, .type = event_type::take, .name = name(0), .table = 2});
+  for (std::int32_t i = 1; i < tables; i++) {
+    events.push_back({.time = start + 3, .type = event_type::take, .name = name(i), .table = i == 1 ? 1 : i + 1});
+  }
+  events.push_back({.time = start + 4, .type = event_type::take, .name = name(tables), .table = 1});
+  for (std::int32_t i = tables; i < clients; i++) {
+    events.push_back({.time = start + 5, .type = event_type::wait, .name = name(i), .table = 0});
+  }
+  events.push_back({.time = start + 6, .type = event_type::wait, .name = name(0), .table = 0});
+  for (std::int32_t i = 0; i < clients; i++) {
+    events.push_back({.time = start + 10 + i, .type = event_type::leave, .name = name(i), .table = 0});
+  }
+  events.push_back({.time = start + 59, .type = event_type::leave, .name = "stranger", .table = 0});
+  return events;
+}
+
+template <typename Processor>
+std::size_t steady_state_allocations(std::int32_t tables, bool batched) {
+  null_buf sink_buf;
+  std::ostream sink(&sink_buf);
+  Processor processor(tables, 100, 0, 24 * 60 - 1, sink);
+  auto run_hour = [&](std::int32_t hour) {
+    auto events = busy_hour(hour * 60, tables);
+    std::size_t before = allocations.load();
+    if (batched) {
+      processor.process_events(events);
+    } else {
+      for (const auto& e : events) {
+        processor.process_event(e);
+      }
+    }
+    return allocations.load() - before;
+  };
+  // Warm-up: until every slot of the waiting ring has held a name, some hours still grow capacity.
+  constexpr std::int32_t warm_up = 4;
+  REQUIRE(run_hour(0) > 0);
+  for (std::int32_t hour = 1; hour < warm_up; hour++) {
+    run_hour(hour);
+  }
+  std::size_t steady = 0;
+  for (std::int32_t hour = warm_up; hour < 23; hour++) {
+    steady += run_hour(hour);
+  }
+  return steady;
+}
+} // namespace
+
+TEST_CASE("Counting operator new sees container allocations", "[allocation]") {
+  std::size_t before = allocations.load();
+  std::size_t bytes_before = allocated_bytes.load();
+  std::vector<int> v(100);
+  REQUIRE(allocations.load() - before == 1);
+  REQUIRE(allocated_bytes.load() - bytes_before == 100 * sizeof(int));
+}
+
+TEST_CASE("A warmed-up processor handles events without allocating", "[allocation]") {
+  REQUIRE(steady_state_allocations<pc_club::event_processor>(4, false) == 0);
+  REQUIRE(steady_state_allocations<pc_club::event_processor>(4, true) == 0);
+  REQUIRE(steady_state_allocations<pc_club::basic_event_processor<pc_club::fixed_layout<5, 100>>>(5, false) == 0);
+}
+
+TEST_CASE("Days whose clients never leave keep memory flat", "[allocation]") {
+  using namespace pc_club;
+  null_buf sink_buf;
+  std::ostream sink(&sink_buf);
+  event_processor processor(4, 100, 0, 24 * 60 - 1, sink);
+  auto run_day = [&](std::int32_t day) {
+    auto events = busy_hour(600, 4);
+    // Arrivals whose leave events are lost; the names repeat every other day.
+    for (std::int32_t i = 10; i < 60; i++) {
+      std::string name = "lost_client_" + std::to_string(day % 2) + "_" + std::to_string(i);
+      events.push_back({.time = 700, .type = event_type::enter, .name = name, .table = 0});
+    }
+    std::size_t before = allocations.load();
+    if (day > 0) {
+      processor.begin_day(0, 24 * 60 - 1);
+    }
+    processor.process_events(events);
+    processor.close();
+    return allocations.load() - before;
+  };
+  REQUIRE(run_day(0) > 0);
+  run_day(1);
+  std::size_t steady = 0;
+  for (std::int32_t day = 2; day < 30; day++) {
+    steady += run_day(day);
+  }
+  REQUIRE(steady == 0);
+}
+
+TEST_CASE("A journaled processor replays retractions without allocating", "[allocation]") {
+  using namespace pc_club;
+  null_buf sink_buf;
+  std::ostream sink(&sink_buf);
+  event_processor processor(4, 100, 0, 24 * 60 - 1, sink);
+  processor.set_journal(true);
+  auto run_day = [&](std::int32_t day) {
+    auto events = busy_hour(600, 4);
+    auto retract = [&](std::int32_t time, std::string name, std::int32_t target_time) {
+      auto at = std::find_if(events.begin(), events.end(), [time](const event& e) { return e.time > time; });
+      events.insert(at, {.time = time, .type = event_type::retract, .name = std::move(name), .table = 0, .target_time = target_time});
+    };
+    // The first client's move to table 2 and a leave; the replays go through most of the hour.
+    retract(607, "regular_client_number_0", 602);
+    retract(658, "regular_client_number_1", 611);
+    std::size_t before = allocations.load();
+    if (day > 0) {
+      processor.begin_day(0, 24 * 60 - 1);
+    }
+    processor.process_events(events);
+    processor.close();
+    return allocations.load() - before;
+  };
+  REQUIRE(run_day(0) > 0);
+  run_day(1);
+  std::size_t steady = 0;
+  for (std::int32_t day = 2; day < 30; day++) {
+    steady += run_day(day);
+  }
+  REQUIRE(steady == 0);
+}
+
+TEST_CASE("A cleared compact bimap refills without allocating", "[allocation]") {
+  compact_bimap<std::string, int> b;
+  auto fill = [&] {
+    for (int i = 0; i < 100; i++) {
+      b.insert("a_name_longer_than_the_small_string_buffer_" + std::to_string(i), i);
+    }
+  };
+  fill();
+  b.clear();
+  std::size_t before = allocations.load();
+  fill();
+  // Only the temporary names are allocated; the nodes and their strings are reused.
+  REQUIRE(allocations.load() - before == 100);
+}
@@ -0,0 +1,317 @@
+#include "bimap.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+template <typename Bimap>
+std::vector<std::pair<typename Bimap::left_t, typename Bimap::right_t>> left_items(const Bimap& b) {
+  std::vector<std::pair<typename Bimap::left_t, typename Bimap::right_t>> items;
+  for (auto it = b.begin_left(); it != b.end_left(); ++it) {
+    items.emplace_back(*it, *it.flip());
+  }
+  return items;
+}
+
+template <typename Bimap>
+std::vector<typename Bimap::right_t> right_keys(const Bimap& b) {
+  std::vector<typename Bimap::right_t> keys;
+  for (auto it = b.begin_right(); it != b.end_right(); ++it) {
+    keys.push_back(*it);
+  }
+  return keys;
+}
+
+// A key whose copy or move can be made to throw.
+struct throwing_key {
+  static inline bool throw_on_copy = false;
+  static inline bool throw_on_move = false;
+
+  int value;
+
+  explicit throwing_key(int value)
+      : value(value) {}
+
+  throwing_key(const throwing_key& other)
+      : value(other.value) {
+    if (throw_on_copy) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  throwing_key(throwing_key&&) = default;
+  throwing_key& operator=(const throwing_key&) = default;
+
+  throwing_key& operator=(throwing_key&& other) {
+    if (throw_on_move) {
+      throw std::runtime_error("move");
+    }
+    value = other.value;
+    return *this;
+  }
+
+  friend bool operator<(const throwing_key& lhs, const throwing_key& rhs) {
+    return lhs.value < rhs.value;
+  }
+
+  friend bool operator==(const throwing_key& lhs, const throwing_key& rhs) {
+    return lhs.value == rhs.value;
+  }
+};
+} // namespace
+
+TEST_CASE("Bulk construction from sorted and unsorted ranges", "[bimap][bulk]") {
+  std::vector<std::pair<int, int>> sorted;
+  for (int i = 0; i < 1000; i++) {
+    sorted.emplace_back(i, 1000 - i);
+  }
+  bimap<int, int> from_sorted(sorted.begin(), sorted.end());
+  REQUIRE(from_sorted.size() == 1000);
+  REQUIRE(left_items(from_sorted) == sorted);
+  REQUIRE(from_sorted.at_right(1) == 999);
+
+  std::vector<std::pair<int, int>> unsorted = {{3, 30}, {1, 10}, {2, 20}};
+  bimap<int, int> from_unsorted(unsorted.begin(), unsorted.end());
+  REQUIRE(left_items(from_unsorted) == std::vector<std::pair<int, int>>{{1, 10}, {2, 20}, {3, 30}});
+  REQUIRE(right_keys(from_unsorted) == std::vector<int>{10, 20, 30});
+
+  bimap<int, int> inserted;
+  for (auto [l, r] : unsorted) {
+    inserted.insert(l, r);
+  }
+  REQUIRE(inserted == from_unsorted);
+}
+
+TEST_CASE("Bulk construction keeps the first of duplicate keys", "[bimap][bulk]") {
+  std::vector<std::pair<std::string, int>> items = {{"b", 1}, {"a", 1}, {"a", 2}, {"c", 3}};
+  bimap<std::string, int> b(items.begin(), items.end());
+  REQUIRE(left_items(b) == std::vector<std::pair<std::string, int>>{{"a", 2}, {"b", 1}, {"c", 3}});
+}
+
+TEST_CASE("Copy of a bimap is equal and independent", "[bimap]") {
+  bimap<int, std::string> b;
+  for (int i = 0; i < 100; i++) {
+    b.insert(i, std::to_string(i));
+  }
+  bimap<int, std::string> copy(b);
+  REQUIRE(copy == b);
+  copy.erase_left(50);
+  REQUIRE(copy.size() == 99);
+  REQUIRE(b.size() == 100);
+  copy.insert(50, "50");
+  REQUIRE(copy == b);
+}
+
+TEST_CASE("Clear and range erase", "[bimap][erase]") {
+  bimap<int, int> b;
+  for (int i = 0; i < 10000; i++) {
+    b.insert(i, -i);
+  }
+  REQUIRE(b.erase_left(b.begin_left(), b.begin_left()) == b.begin_left());
+  REQUIRE(b.size() == 10000);
+
+  auto first = b.find_left(10), last = b.find_left(9990);
+  REQUIRE(b.erase_left(first, last) == b.find_left(9990));
+  REQUIRE(b.size() == 20);
+  REQUIRE(b.find_right(-10) == b.end_right());
+  REQUIRE(*b.find_right(-9).flip() == 9);
+
+  REQUIRE(b.erase_right(b.begin_right(), b.end_right()) == b.end_right());
+  REQUIRE(b.empty());
+
+  b.insert(1, 1);
+  b.clear();
+  REQUIRE(b.empty());
+  REQUIRE(b.begin_left() == b.end_left());
+  REQUIRE(b.begin_right() == b.end_right());
+  b.insert(2, 2);
+  REQUIRE(b.at_left(2) == 2);
+}
+
+TEST_CASE("Large range erase relinks the kept nodes into balanced trees", "[bimap][erase]") {
+  bimap<int, int> b;
+  for (int i = 0; i < 4096; i++) {
+    b.insert(i, 4096 - i);
+  }
+  // In-order inserts leave a list; erasing most of it node by node would keep that shape.
+  REQUIRE(b.stats().left.height == 4096);
+
+  auto last = b.find_right(2001);
+  REQUIRE(b.erase_right(b.begin_right(), last) == last);
+  REQUIRE(b.size() == 2096);
+  REQUIRE(b.stats().left.height <= 12);
+  REQUIRE(b.stats().right.height <= 12);
+  REQUIRE(b.find_left(2096) == b.end_left());
+  REQUIRE(b.find_left(2095) != b.end_left());
+  REQUIRE(b.at_left(2095) == 2001);
+  REQUIRE(*b.begin_left() == 0);
+  REQUIRE(*std::prev(b.end_right()) == 4096);
+
+  // The tail of a side, up to its end.
+  REQUIRE(b.erase_left(b.find_left(100), b.end_left()) == b.end_left());
+  REQUIRE(b.size() == 100);
+  int expected = 0;
+  for (auto it = b.begin_left(); it != b.end_left(); ++it) {
+    REQUIRE(*it == expected);
+    REQUIRE(*it.flip() == 4096 - expected);
+    expected++;
+  }
+  REQUIRE(expected == 100);
+
+  // A short range is still erased node by node, and the map stays usable either way.
+  REQUIRE(b.erase_left(b.find_left(10), b.find_left(12)) == b.find_left(12));
+  REQUIRE(b.size() == 98);
+  REQUIRE(b.insert(10, 1) != b.end_left());
+  REQUIRE(b.at_right(1) == 10);
+}
+
+TEST_CASE("Extracted node can be rekeyed and reinserted", "[bimap][node]") {
+  bimap<std::string, int> b;
+  b.insert("a", 1);
+  b.insert("b", 2);
+
+  auto node = b.extract_left("a");
+  REQUIRE(node);
+  REQUIRE(b.size() == 1);
+  REQUIRE(b.find_right(1) == b.end_right());
+  REQUIRE(node.left() == "a");
+
+  node.right() = 2;
+  auto clash = b.insert(std::move(node));
+  REQUIRE_FALSE(clash.inserted);
+  REQUIRE(clash.position == b.end_left());
+  REQUIRE(clash.node);
+
+  clash.node.right() = 3;
+  auto ok = b.insert(std::move(clash.node));
+  REQUIRE(ok.inserted);
+  REQUIRE(*ok.position == "a");
+  REQUIRE(b.at_right(3) == "a");
+  REQUIRE(b.size() == 2);
+
+  REQUIRE(b.extract_right(42).empty());
+}
+
+TEST_CASE("replace_right relinks only the right side", "[bimap][node]") {
+  bimap<std::string, int> b;
+  for (int i = 1; i <= 5; i++) {
+    b.insert(std::string(1, static_cast<char>('a' + i - 1)), i * 10);
+  }
+  auto it = b.find_left("c");
+  const std::string* name = &*it;
+
+  REQUIRE(b.replace_right(it, 20) == b.end_left());
+  REQUIRE(b.replace_right(it, 30) == it);
+  REQUIRE(b.replace_right(it, 55) == it);
+  REQUIRE(&*b.find_left("c") == name);
+  REQUIRE(b.at_right(55) == "c");
+  REQUIRE(b.find_right(30) == b.end_right());
+  REQUIRE(right_keys(b) == std::vector<int>{10, 20, 40, 50, 55});
+
+  REQUIRE(*b.replace_left(b.find_right(10), std::string("z")) == 10);
+  REQUIRE(b.at_left("z") == 10);
+  REQUIRE(b.find_left("a") == b.end_left());
+}
+
+TEST_CASE("replace_right keeps the bimap consistent when the key throws", "[bimap][node]") {
+  bimap<std::string, throwing_key> b;
+  for (int i = 1; i <= 3; i++) {
+    b.insert(std::string(1, static_cast<char>('a' + i - 1)), throwing_key(i));
+  }
+  auto it = b.find_left("b");
+  throwing_key five(5);
+
+  throwing_key::throw_on_copy = true;
+  REQUIRE_THROWS(b.replace_right(it, five));
+  throwing_key::throw_on_copy = false;
+  REQUIRE(b.size() == 3);
+  REQUIRE(b.at_right(throwing_key(2)) == "b");
+  REQUIRE(right_keys(b) == std::vector<throwing_key>{throwing_key(1), throwing_key(2), throwing_key(3)});
+
+  throwing_key::throw_on_move = true;
+  REQUIRE_THROWS(b.replace_right(it, throwing_key(6)));
+  throwing_key::throw_on_move = false;
+  REQUIRE(b.size() == 2);
+  REQUIRE(b.find_left("b") == b.end_left());
+  REQUIRE(right_keys(b) == std::vector<throwing_key>{throwing_key(1), throwing_key(3)});
+  REQUIRE(left_items(b).size() == 2);
+}
+
+TEST_CASE("Iteration stays ordered through inserts, erases, swaps and moves", "[bimap][iterator]") {
+  std::map<int, int> reference;
+  bimap<int, int> b, other;
+  std::mt19937 gen(42);
+  for (int step = 0; step < 2000; step++) {
+    int l = static_cast<int>(gen() % 300), r = static_cast<int>(gen() % 300);
+    if (gen() % 3 == 0) {
+      if (b.erase_left(l)) {
+        reference.erase(l);
+      }
+    } else if (b.insert(l, r) != b.end_left()) {
+      reference.emplace(l, r);
+    }
+    if (step % 500 == 0) {
+      swap(b, other);
+      swap(b, other);
+      bimap<int, int> moved(std::move(b));
+      b = std::move(moved);
+    }
+  }
+
+  std::vector<std::pair<int, int>> expected(reference.begin(), reference.end());
+  REQUIRE(left_items(b) == expected);
+
+  std::vector<std::pair<int, int>> backwards;
+  for (auto it = b.end_left(); it != b.begin_left();) {
+    --it;
+    backwards.emplace_back(*it, *it.flip());
+  }
+  std::reverse(backwards.begin(), backwards.end());
+  REQUIRE(backwards == expected);
+
+  std::vector<int> rights;
+  for (auto [l, r] : expected) {
+    rights.push_back(r);
+  }
+  std::sort(rights.begin(), rights.end());
+  REQUIRE(right_keys(b) == rights);
+  REQUIRE(std::prev(b.end_right()) == b.find_right(rights.back()));
+}
+
+TEST_CASE("Stats report tree shape and footprint", "[bimap][stats]") {
+  bimap<int, int> empty;
+  REQUIRE(empty.stats().nodes == 0);
+  REQUIRE(empty.stats().left.height == 0);
+  REQUIRE(empty.stats().total_bytes == sizeof(empty));
+
+  // Ascending inserts degenerate the left tree into a list; descending rights do the same on the right.
+  bimap<int, int> chain;
+  for (int i = 0; i < 100; i++) {
+    chain.insert(i, 100 - i);
+  }
+  auto stats = chain.stats();
+  REQUIRE(stats.nodes == 100);
+  REQUIRE(stats.left.height == 100);
+  REQUIRE(stats.right.height == 100);
+  REQUIRE(stats.left.average_depth == 50.5);
+  REQUIRE(stats.left.imbalance == 100.0 / 7);
+  REQUIRE(stats.total_bytes == sizeof(chain) + 100 * stats.node_bytes);
+
+  // Bulk construction links both trees perfectly balanced.
+  std::vector<std::pair<int, int>> items;
+  for (int i = 0; i < 100; i++) {
+    items.emplace_back(i, 100 - i);
+  }
+  bimap<int, int> balanced(items.begin(), items.end());
+  REQUIRE(balanced.stats().left.height == 7);
+  REQUIRE(balanced.stats().right.height == 7);
+  REQUIRE(balanced.stats().left.imbalance == 1);
+  REQUIRE(balanced.stats().left.average_depth < 6);
+}
@@ -0,0 +1,87 @@
+#include "client_analytics.h"
+#include "event_processor.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("Analytics table keeps every client through growth", "[client_analytics]") {
+  pc_club::client_analytics analytics;
+  for (int i = 0; i < 1000; i++) {
+    analytics.record_session("client" + std::to_string(i), i, i * 10);
+  }
+  analytics.record_wait("client7");
+  REQUIRE(analytics.size() == 1000);
+  for (int i = 0; i < 1000; i++) {
+    const auto* stats = analytics.find("client" + std::to_string(i));
+    REQUIRE(stats);
+    REQUIRE(stats->spend == i * 10);
+  }
+  REQUIRE(analytics.find("client7")->waits == 1);
+  REQUIRE(analytics.find("nobody") == nullptr);
+  REQUIRE(pc_club::client_analytics().find("nobody") == nullptr);
+}
+
+TEST_CASE("Top spenders are ordered by spend, then name", "[client_analytics]") {
+  pc_club::client_analytics analytics;
+  analytics.record_session("c", 60, 100);
+  analytics.record_session("a", 60, 300);
+  analytics.record_session("b", 60, 300);
+  analytics.record_session("d", 60, 50);
+  analytics.record_turn_away("e");
+
+  auto top = analytics.top_spenders(3);
+  REQUIRE(top.size() == 3);
+  REQUIRE(top[0].first == "a");
+  REQUIRE(top[1].first == "b");
+  REQUIRE(top[2].first == "c");
+  REQUIRE(analytics.top_spenders(10).size() == 5);
+  REQUIRE(analytics.top_spenders(0).empty());
+}
+
+TEST_CASE("Merged days match one combined table", "[client_analytics]") {
+  pc_club::client_analytics monday, tuesday, combined;
+  for (int i = 0; i < 50; i++) {
+    std::string name = "c" + std::to_string(i % 17);
+    (i % 2 == 0 ? monday : tuesday).record_session(name, i, i);
+    combined.record_session(name, i, i);
+    if (i % 5 == 0) {
+      tuesday.record_wait(name);
+      combined.record_wait(name);
+    }
+  }
+  monday.merge(tuesday);
+  REQUIRE(monday.size() == combined.size());
+  for (int i = 0; i < 17; i++) {
+    std::string name = "c" + std::to_string(i);
+    REQUIRE(monday.find(name)->spend == combined.find(name)->spend);
+    REQUIRE(monday.find(name)->seat_time == combined.find(name)->seat_time);
+    REQUIRE(monday.find(name)->waits == combined.find(name)->waits);
+  }
+}
+
+TEST_CASE("Processor reports sessions, waits and turn-aways", "[client_analytics]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  client_analytics analytics;
+  event_processor ep(1, 10, 0, 600, out);
+  ep.set_analytics(&analytics);
+  for (const char* name : {"a", "b", "c"}) {
+    ep.process_event({.time = 0, .type = event_type::enter, .name = name, .table = 0});
+  }
+  ep.process_event({.time = 0, .type = event_type::take, .name = "a", .table = 1});
+  ep.process_event({.time = 10, .type = event_type::wait, .name = "b", .table = 0});
+  ep.process_event({.time = 20, .type = event_type::wait, .name = "c", .table = 0});
+  ep.process_event({.time = 90, .type = event_type::leave, .name = "a", .table = 0});
+  ep.close();
+
+  REQUIRE(analytics.find("a")->spend == 20);
+  REQUIRE(analytics.find("a")->seat_time == 90);
+  REQUIRE(analytics.find("b")->waits == 1);
+  REQUIRE(analytics.find("b")->spend == 90);
+  REQUIRE(analytics.find("b")->seat_time == 510);
+  REQUIRE(analytics.find("c")->turn_aways == 1);
+  REQUIRE(analytics.find("c")->spend == 0);
+}
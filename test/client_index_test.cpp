@@ -0,0 +1,142 @@
+#include "client_index.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+pc_club::client_index::id add(pc_club::client_index& clients, const std::string& name) {
+  return clients.find_or_insert(name, pc_club::hash_name(name));
+}
+
+std::vector<std::string> queue_of(const pc_club::client_index& clients) {
+  std::vector<std::string> names;
+  clients.for_each_queued([&](const pc_club::client_record& client) { names.push_back(client.name); });
+  return names;
+}
+} // namespace
+
+TEST_CASE("Client index finds the same record by name, table and queue", "[client_index]") {
+  using namespace pc_club;
+  client_index clients(2);
+  auto a = add(clients, "a");
+  auto b = add(clients, "b");
+  REQUIRE(add(clients, "a") == a);
+  REQUIRE(clients.find("b", hash_name("b")) == b);
+  REQUIRE(clients.find("c", hash_name("c")) == client_index::none);
+  REQUIRE(clients.size() == 2);
+
+  REQUIRE(clients.seat(a, 1, 600));
+  REQUIRE_FALSE(clients.seat(a, 2, 610));
+  REQUIRE(clients.at_table(1) == a);
+  REQUIRE(clients.at_table(2) == client_index::none);
+  REQUIRE(clients[a].table == 1);
+  REQUIRE(clients[a].seated_since == 600);
+
+  clients.unseat(1);
+  REQUIRE(clients.seat(a, 2, 620));
+  REQUIRE(clients.at_table(1) == client_index::none);
+  REQUIRE(clients.at_table(2) == a);
+  REQUIRE(clients[a].seated_since == 620);
+  REQUIRE(clients.seated() == 1);
+
+  clients.enqueue(b);
+  clients.enqueue(a);
+  REQUIRE(clients.queue_full());
+  REQUIRE(queue_of(clients) == std::vector<std::string>{"b", "a"});
+  REQUIRE(clients.dequeue() == b);
+  REQUIRE(clients[b].queued == 0);
+  REQUIRE(clients.dequeue() == a);
+  REQUIRE(clients.dequeue() == client_index::none);
+
+  clients.unseat(2);
+  REQUIRE(clients.seated() == 0);
+  REQUIRE(clients[a].table == 0);
+}
+
+TEST_CASE("Client index keeps a record while the client is present, seated or queued", "[client_index]") {
+  using namespace pc_club;
+  client_index clients(1);
+  auto a = add(clients, "a");
+  clients[a].present = true;
+  clients.seat(a, 1, 600);
+  clients.enqueue(a);
+
+  clients[a].present = false;
+  clients.release(a);
+  clients.unseat(1);
+  clients.release(a);
+  REQUIRE(clients.find("a", hash_name("a")) == a);
+  REQUIRE(clients.dequeue() == a);
+  clients.release(a);
+  REQUIRE(clients.find("a", hash_name("a")) == client_index::none);
+  REQUIRE(clients.size() == 0);
+
+  // The released id is handed to the next client, with a fresh record.
+  auto b = add(clients, "b");
+  REQUIRE(b == a);
+  REQUIRE(clients[b].name == "b");
+  REQUIRE_FALSE(clients[b].present);
+  REQUIRE(clients[b].table == 0);
+  REQUIRE(clients[b].queued == 0);
+}
+
+TEST_CASE("Client index clears and gives back storage after a peak", "[client_index]") {
+  using namespace pc_club;
+  client_index clients(3);
+  for (int i = 0; i < 1000; i++) {
+    add(clients, "c" + std::to_string(i));
+  }
+  clients.seat(0, 3, 600);
+  clients.enqueue(1);
+  clients.clear();
+  REQUIRE(clients.size() == 0);
+  REQUIRE(clients.seated() == 0);
+  REQUIRE(clients.at_table(3) == client_index::none);
+  REQUIRE(clients.queued() == 0);
+  REQUIRE(clients.find("c0", hash_name("c0")) == client_index::none);
+  REQUIRE(add(clients, "x") == 0);
+
+  clients.clear();
+  clients.compact(10);
+  for (int i = 0; i < 10; i++) {
+    REQUIRE(add(clients, "d" + std::to_string(i)) == static_cast<client_index::id>(i));
+  }
+  REQUIRE(clients.size() == 10);
+}
+
+TEST_CASE("Client index undoes journaled changes newest first", "[client_index]") {
+  using namespace pc_club;
+  client_index clients(2);
+  auto a = add(clients, "a");
+  clients.set_present(a, true);
+  clients.seat(a, 1, 600);
+  clients.set_journaling(true);
+  const std::size_t mark = clients.journal_size();
+
+  auto b = add(clients, "b");
+  clients.set_present(b, true);
+  clients.enqueue(b);
+  clients.unseat(1);
+  clients.seat(a, 2, 620);
+  clients.set_present(a, false);
+  clients.unseat(2);
+  clients.release(a);
+  REQUIRE(clients.find("a", hash_name("a")) == client_index::none);
+  // Released ids are not reused while journaling, so undo can bring the name back.
+  REQUIRE(add(clients, "c") != a);
+
+  clients.undo(mark);
+  REQUIRE(clients.size() == 1);
+  REQUIRE(clients.find("a", hash_name("a")) == a);
+  REQUIRE(clients.find("b", hash_name("b")) == client_index::none);
+  REQUIRE(clients.find("c", hash_name("c")) == client_index::none);
+  REQUIRE(clients[a].present);
+  REQUIRE(clients[a].table == 1);
+  REQUIRE(clients[a].seated_since == 600);
+  REQUIRE(clients.at_table(1) == a);
+  REQUIRE(clients.at_table(2) == client_index::none);
+  REQUIRE(clients.seated() == 1);
+  REQUIRE(clients.queued() == 0);
+}
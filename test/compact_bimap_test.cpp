@@ -0,0 +1,179 @@
+#include "compact-bimap.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+// A key whose copy or move can be made to throw.
+struct throwing_key {
+  static inline bool throw_on_copy = false;
+  static inline bool throw_on_move = false;
+
+  int value;
+
+  explicit throwing_key(int value)
+      : value(value) {}
+
+  throwing_key(const throwing_key& other)
+      : value(other.value) {
+    if (throw_on_copy) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  throwing_key(throwing_key&&) = default;
+  throwing_key& operator=(const throwing_key&) = default;
+
+  throwing_key& operator=(throwing_key&& other) {
+    if (throw_on_move) {
+      throw std::runtime_error("move");
+    }
+    value = other.value;
+    return *this;
+  }
+
+  friend bool operator<(const throwing_key& lhs, const throwing_key& rhs) {
+    return lhs.value < rhs.value;
+  }
+};
+} // namespace
+
+TEST_CASE("Compact bimap matches std::map under random inserts and erases", "[compact_bimap]") {
+  std::map<int, int> reference;
+  compact_bimap<int, int> b;
+  std::mt19937 gen(7);
+  for (int step = 0; step < 5000; step++) {
+    int l = static_cast<int>(gen() % 500), r = static_cast<int>(gen() % 500);
+    switch (gen() % 4) {
+    case 0:
+      if (b.erase_left(l)) {
+        reference.erase(l);
+      }
+      break;
+    case 1:
+      if (auto it = b.find_left(l); it != b.end_left() && b.replace_right(it, r) != b.end_left()) {
+        reference[l] = r;
+      }
+      break;
+    default:
+      if (b.insert(l, r) != b.end_left()) {
+        reference.emplace(l, r);
+      }
+    }
+  }
+
+  REQUIRE(b.size() == reference.size());
+  std::vector<std::pair<int, int>> items;
+  for (auto it = b.begin_left(); it != b.end_left(); ++it) {
+    items.emplace_back(*it, *it.flip());
+  }
+  REQUIRE(items == std::vector<std::pair<int, int>>(reference.begin(), reference.end()));
+
+  std::vector<int> rights, expected_rights;
+  for (auto it = b.begin_right(); it != b.end_right(); ++it) {
+    rights.push_back(*it);
+    REQUIRE(reference.at(*it.flip()) == *it);
+  }
+  for (auto [l, r] : reference) {
+    expected_rights.push_back(r);
+  }
+  std::sort(expected_rights.begin(), expected_rights.end());
+  REQUIRE(rights == expected_rights);
+}
+
+TEST_CASE("Compact bimap iterators survive storage growth", "[compact_bimap]") {
+  compact_bimap<std::string, int> b;
+  auto first = b.insert("first", 0);
+  for (int i = 1; i < 1000; i++) {
+    b.insert("n" + std::to_string(i), i);
+  }
+  REQUIRE(*first == "first");
+  REQUIRE(*first.flip() == 0);
+  REQUIRE(b.at_right(0) == "first");
+
+  b.erase_right(b.begin_right(), b.end_right());
+  REQUIRE(b.empty());
+  b.insert("again", 1);
+  REQUIRE(b.at_left("again") == 1);
+  b.clear();
+  REQUIRE(b.begin_left() == b.end_left());
+}
+
+TEST_CASE("Compact bimap refills its cleared storage", "[compact_bimap]") {
+  compact_bimap<std::string, int> b;
+  for (int i = 0; i < 100; i++) {
+    b.insert("n" + std::to_string(i), i);
+  }
+  const auto full = b.stats();
+  REQUIRE(full.nodes == 100);
+  b.clear();
+  REQUIRE(b.empty());
+  REQUIRE(b.begin_right() == b.end_right());
+  REQUIRE(b.find_left("n1") == b.end_left());
+
+  for (int i = 0; i < 100; i++) {
+    b.insert("m" + std::to_string(i), 100 - i);
+  }
+  REQUIRE(b.stats().total_bytes == full.total_bytes);
+  REQUIRE(b.size() == 100);
+  REQUIRE(b.at_right(1) == "m99");
+  REQUIRE(*b.begin_left() == "m0");
+  REQUIRE(std::is_sorted(b.begin_right(), b.end_right()));
+}
+
+TEST_CASE("Compact bimap copy, move and swap", "[compact_bimap]") {
+  compact_bimap<int, int> a;
+  for (int i = 0; i < 10; i++) {
+    a.insert(i, 10 - i);
+  }
+  compact_bimap<int, int> copy(a);
+  REQUIRE(copy == a);
+
+  compact_bimap<int, int> moved(std::move(copy));
+  REQUIRE(moved == a);
+  REQUIRE(copy.empty());
+  REQUIRE(copy.begin_left() == copy.end_left());
+  copy.insert(1, 1);
+  REQUIRE(copy.size() == 1);
+
+  swap(copy, moved);
+  REQUIRE(copy == a);
+  REQUIRE(moved.at_left(1) == 1);
+}
+
+TEST_CASE("Compact bimap stays consistent when a replaced key throws", "[compact_bimap]") {
+  compact_bimap<std::string, throwing_key> b;
+  for (int i = 1; i <= 3; i++) {
+    b.insert(std::string(1, static_cast<char>('a' + i - 1)), throwing_key(i));
+  }
+  auto it = b.find_left("b");
+  throwing_key five(5);
+
+  throwing_key::throw_on_copy = true;
+  REQUIRE_THROWS(b.replace_right(it, five));
+  throwing_key::throw_on_copy = false;
+  REQUIRE(b.size() == 3);
+  REQUIRE(b.at_right(throwing_key(2)) == "b");
+
+  throwing_key::throw_on_move = true;
+  REQUIRE_THROWS(b.replace_right(it, throwing_key(6)));
+  throwing_key::throw_on_move = false;
+  REQUIRE(b.size() == 2);
+  REQUIRE(b.find_left("b") == b.end_left());
+  std::vector<int> rights;
+  for (auto r = b.begin_right(); r != b.end_right(); ++r) {
+    rights.push_back(r->value);
+  }
+  REQUIRE(rights == std::vector<int>{1, 3});
+
+  b.insert("d", throwing_key(4));
+  REQUIRE(b.size() == 3);
+  REQUIRE(b.stats().nodes == 3);
+}
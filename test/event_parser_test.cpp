@@ -0,0 +1,72 @@
+#include "event_parser.h"
+
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("Times are two-digit hours and minutes", "[parser]") {
+  using pc_club::parse_time;
+  REQUIRE(parse_time("00:00") == 0);
+  REQUIRE(parse_time("09:41") == 581);
+  REQUIRE(parse_time("23:59") == 1439);
+  REQUIRE(parse_time("24:00") == -1);
+  REQUIRE(parse_time("12:60") == -1);
+  REQUIRE(parse_time("9:41") == -1);
+  REQUIRE(parse_time("09-41") == -1);
+  REQUIRE(parse_time("0a:41") == -1);
+}
+
+TEST_CASE("Event lines are validated against the club", "[parser]") {
+  using namespace pc_club;
+  event e{};
+  REQUIRE(parse_event("09:54 2 client1 1", 3, e));
+  REQUIRE(e.time == 594);
+  REQUIRE(e.type == event_type::take);
+  REQUIRE(e.name == "client1");
+  REQUIRE(e.table == 1);
+  REQUIRE(e.name_hash == hash_name("client1"));
+
+  REQUIRE(parse_event("  12:33   4 client_1  ", 3, e));
+  REQUIRE(e.type == event_type::leave);
+  REQUIRE(e.table == -1);
+
+  REQUIRE_FALSE(parse_event("09:54 2 client1 4", 3, e));
+  REQUIRE_FALSE(parse_event("09:54 2 client1 0", 3, e));
+  REQUIRE_FALSE(parse_event("09:54 2 client1 99999999999", 3, e));
+  REQUIRE_FALSE(parse_event("09:54 2 client1", 3, e));
+  REQUIRE_FALSE(parse_event("09:54 1 client1 1", 3, e));
+  REQUIRE_FALSE(parse_event("09:54 5 client1", 3, e, true));
+  REQUIRE_FALSE(parse_event("09:54 5 client1 1", 3, e, true));
+  REQUIRE_FALSE(parse_event("09:54 5 client1 09:55", 3, e, true));
+  REQUIRE_FALSE(parse_event("09:54 1 Client1", 3, e));
+  REQUIRE_FALSE(parse_event("09:54 1 client1 1 extra", 3, e));
+  REQUIRE_FALSE(parse_event("9:54 1 client1", 3, e));
+  REQUIRE_FALSE(parse_event("", 3, e));
+}
+
+TEST_CASE("A retraction names the time of the event it takes back", "[parser]") {
+  using namespace pc_club;
+  event e{};
+  // Without `--corrections` the line is malformed, as it always was.
+  REQUIRE_FALSE(parse_event("19:05 5 client1 19:02", 3, e));
+  REQUIRE(parse_event("19:05 5 client1 19:02", 3, e, true));
+  REQUIRE(e.time == 1145);
+  REQUIRE(e.type == event_type::retract);
+  REQUIRE(e.name == "client1");
+  REQUIRE(e.target_time == 1142);
+  REQUIRE(e.table == -1);
+
+  REQUIRE(parse_event("19:05 4 client1", 3, e));
+  REQUIRE(e.target_time == -1);
+}
+
+TEST_CASE("Header lines", "[parser]") {
+  std::int32_t value = 0, open = 0, close = 0;
+  REQUIRE(pc_club::parse_tables("3", value));
+  REQUIRE(value == 3);
+  REQUIRE_FALSE(pc_club::parse_tables("0", value));
+  REQUIRE_FALSE(pc_club::parse_price("ten", value));
+  REQUIRE(pc_club::parse_hours("09:00 19:00", open, close));
+  REQUIRE(open == 540);
+  REQUIRE(close == 1140);
+  REQUIRE_FALSE(pc_club::parse_hours("19:00 09:00", open, close));
+  REQUIRE_FALSE(pc_club::parse_hours("09:00", open, close));
+}
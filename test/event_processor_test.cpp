@@ -2,7 +2,11 @@
 
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -190,3 +194,344 @@ TEST_CASE("Multiple tables revenue and usage aggregation", "[close][revenue][usa
   REQUIRE(lines[lines.size() - 2] == "1 14 01:01");
   REQUIRE(lines[lines.size() - 1] == "2 21 02:30");
 }
+
+TEST_CASE("Moving to another table frees the old one", "[take]") {
+  using namespace pc_club;
+  std::ostringstream oss;
+  auto* old = std::cout.rdbuf(oss.rdbuf());
+
+  event_processor ep(2, 10, 0, 240);
+  ep.process_event({.time = 0, .type = event_type::enter, .name = "A", .table = -1});
+  ep.process_event({.time = 0, .type = event_type::take, .name = "A", .table = 1});
+  ep.process_event({.time = 1, .type = event_type::enter, .name = "B", .table = -1});
+  ep.process_event({.time = 100, .type = event_type::take, .name = "A", .table = 2});
+  ep.process_event({.time = 100, .type = event_type::take, .name = "B", .table = 2});
+  ep.process_event({.time = 101, .type = event_type::take, .name = "B", .table = 1});
+  ep.process_event({.time = 200, .type = event_type::leave, .name = "A", .table = -1});
+
+  ep.close();
+  std::cout.rdbuf(old);
+
+  auto lines = split_lines(oss.str());
+  REQUIRE(lines[4] == "01:40 2 A 2");
+  REQUIRE(lines[5] == "01:40 2 B 2");
+  REQUIRE(lines[6] == "01:40 13 PlaceIsBusy");
+  REQUIRE(lines[7] == "01:41 2 B 1");
+  REQUIRE(lines[8] == "03:20 4 A");
+  REQUIRE(lines[lines.size() - 2] == "1 50 03:59");
+  REQUIRE(lines[lines.size() - 1] == "2 20 01:40");
+}
+
+TEST_CASE("Fixed layout processor matches the dynamic one", "[fixed_layout]") {
+  using namespace pc_club;
+  std::vector<event> events = {
+      {.time = 530, .type = event_type::enter, .name = "early", .table = -1},
+      {.time = 541, .type = event_type::enter, .name = "a", .table = -1},
+      {.time = 548, .type = event_type::enter, .name = "b", .table = -1},
+      {.time = 552, .type = event_type::wait, .name = "a", .table = -1},
+      {.time = 554, .type = event_type::take, .name = "a", .table = 1},
+      {.time = 625, .type = event_type::take, .name = "b", .table = 2},
+      {.time = 658, .type = event_type::enter, .name = "c", .table = -1},
+      {.time = 659, .type = event_type::take, .name = "c", .table = 3},
+      {.time = 690, .type = event_type::enter, .name = "d", .table = -1},
+      {.time = 695, .type = event_type::take, .name = "d", .table = 2},
+      {.time = 705, .type = event_type::wait, .name = "d", .table = -1},
+      {.time = 753, .type = event_type::leave, .name = "a", .table = -1},
+      {.time = 763, .type = event_type::leave, .name = "b", .table = -1},
+      {.time = 780, .type = event_type::take, .name = "c", .table = 2},
+      {.time = 952, .type = event_type::leave, .name = "d", .table = -1},
+  };
+  auto run = [&events]<typename Processor>(Processor processor) {
+    for (const auto& e : events) {
+      processor.process_event(e);
+    }
+    processor.close();
+  };
+
+  std::ostringstream dynamic_out, fixed_out;
+  auto* old = std::cout.rdbuf(dynamic_out.rdbuf());
+  run(event_processor(3, 10, 540, 1140));
+  std::cout.rdbuf(fixed_out.rdbuf());
+  run(basic_event_processor<fixed_layout<3, 10>>(3, 10, 540, 1140));
+  std::cout.rdbuf(old);
+
+  REQUIRE(fixed_out.str() == dynamic_out.str());
+  REQUIRE(split_lines(fixed_out.str()).back() == "3 30 02:01");
+}
+
+TEST_CASE("Dispatch picks a fixed layout only for matching clubs", "[fixed_layout]") {
+  using namespace pc_club;
+  std::ostringstream oss;
+  auto* old = std::cout.rdbuf(oss.rdbuf());
+
+  bool fixed = false;
+  with_event_processor(3, 10, 0, 60, [&fixed]<typename Processor>(Processor&) {
+    fixed = !std::is_same_v<Processor, event_processor>;
+  });
+  REQUIRE(fixed);
+  with_event_processor(4, 10, 0, 60, [&fixed]<typename Processor>(Processor&) {
+    fixed = !std::is_same_v<Processor, event_processor>;
+  });
+  REQUIRE_FALSE(fixed);
+  REQUIRE_THROWS_AS((fixed_layout<3, 10>(4, 10)), std::invalid_argument);
+
+  std::cout.rdbuf(old);
+}
+
+TEST_CASE("Batched processing matches processing one event at a time", "[process_events]") {
+  using namespace pc_club;
+  std::mt19937 rng(7);
+  std::vector<event> events;
+  for (std::int32_t i = 0; i < 2000; i++) {
+    auto type = static_cast<event_type>(1 + rng() % 4);
+    std::int32_t table = type == event_type::take ? 1 + static_cast<std::int32_t>(rng() % 5) : -1;
+    events.push_back({.time = 500 + i / 4, .type = type, .name = "c" + std::to_string(rng() % 12), .table = table});
+  }
+
+  std::ostringstream single_out, batch_out, split_out;
+  event_processor single(5, 100, 540, 1140, single_out);
+  for (const auto& e : events) {
+    single.process_event(e);
+  }
+  single.close();
+
+  event_processor batch(5, 100, 540, 1140, batch_out);
+  batch.process_events(events);
+  batch.close();
+
+  std::span<const event> all(events);
+  event_processor split(5, 100, 540, 1140, split_out);
+  split.process_events(all.first(3));
+  split.process_events(all.subspan(3, 0));
+  split.process_events(all.subspan(3));
+  split.close();
+
+  REQUIRE(batch_out.str() == single_out.str());
+  REQUIRE(split_out.str() == single_out.str());
+}
+
+TEST_CASE("A seated client called from the queue leaves the freed table free", "[assign_next]") {
+  using namespace pc_club;
+  std::ostringstream oss;
+  event_processor ep(2, 10, 0, 600, oss);
+  ep.process_event({.time = 1, .type = event_type::enter, .name = "a", .table = -1});
+  ep.process_event({.time = 1, .type = event_type::enter, .name = "b", .table = -1});
+  ep.process_event({.time = 1, .type = event_type::enter, .name = "c", .table = -1});
+  ep.process_event({.time = 2, .type = event_type::take, .name = "a", .table = 1});
+  ep.process_event({.time = 2, .type = event_type::take, .name = "b", .table = 2});
+  ep.process_event({.time = 3, .type = event_type::wait, .name = "a", .table = -1});
+  ep.process_event({.time = 4, .type = event_type::leave, .name = "b", .table = -1});
+  ep.process_event({.time = 5, .type = event_type::take, .name = "c", .table = 2});
+
+  auto lines = split_lines(oss.str());
+  REQUIRE(lines[8] == "00:04 12 a 2");
+  REQUIRE(lines[9] == "00:05 2 c 2");
+  REQUIRE(lines.size() == 10);
+}
+
+TEST_CASE("A seated client who is also queued moves tables", "[take][assign_next]") {
+  using namespace pc_club;
+  std::ostringstream oss;
+  event_processor ep(3, 10, 0, 600, oss);
+  for (const char* name : {"a", "b", "c"}) {
+    ep.process_event({.time = 1, .type = event_type::enter, .name = name, .table = -1});
+  }
+  ep.process_event({.time = 2, .type = event_type::take, .name = "a", .table = 1});
+  ep.process_event({.time = 2, .type = event_type::take, .name = "b", .table = 2});
+  ep.process_event({.time = 2, .type = event_type::take, .name = "c", .table = 3});
+  ep.process_event({.time = 3, .type = event_type::wait, .name = "b", .table = -1});
+  ep.process_event({.time = 3, .type = event_type::wait, .name = "a", .table = -1});
+  // b is called first and keeps table 2, so table 3 stays free with a still queued.
+  ep.process_event({.time = 4, .type = event_type::leave, .name = "c", .table = -1});
+  // Leaving table 1 calls a back to it, and the table a asked for stays free.
+  ep.process_event({.time = 5, .type = event_type::take, .name = "a", .table = 3});
+  // Table 3 really is free: b can take it.
+  ep.process_event({.time = 6, .type = event_type::take, .name = "b", .table = 3});
+  ep.close();
+
+  auto lines = split_lines(oss.str());
+  REQUIRE(lines[11] == "00:05 2 a 3");
+  REQUIRE(lines[12] == "00:05 12 a 1");
+  REQUIRE(lines[13] == "00:06 2 b 3");
+  REQUIRE(lines[15] == "1 110 09:58");
+  REQUIRE(lines[16] == "2 10 00:04");
+  REQUIRE(lines[17] == "3 110 09:56");
+}
+
+TEST_CASE("A processor runs one day after another", "[begin_day]") {
+  using namespace pc_club;
+  const std::vector<event> first = {
+      {.time = 541, .type = event_type::enter, .name = "a", .table = -1},
+      {.time = 541, .type = event_type::enter, .name = "b", .table = -1},
+      {.time = 542, .type = event_type::take, .name = "a", .table = 1},
+      {.time = 543, .type = event_type::take, .name = "b", .table = 2},
+      {.time = 544, .type = event_type::enter, .name = "c", .table = -1},
+      {.time = 545, .type = event_type::wait, .name = "c", .table = -1},
+  };
+  // "a" and "c" never left yesterday, so today they are strangers.
+  const std::vector<event> second = {
+      {.time = 601, .type = event_type::take, .name = "a", .table = 1},
+      {.time = 602, .type = event_type::leave, .name = "c", .table = -1},
+      {.time = 603, .type = event_type::enter, .name = "c", .table = -1},
+      {.time = 604, .type = event_type::take, .name = "c", .table = 2},
+      {.time = 700, .type = event_type::leave, .name = "c", .table = -1},
+  };
+
+  std::ostringstream out;
+  event_processor ep(2, 10, 540, 1140, out);
+  ep.process_events(first);
+  ep.close();
+  out.str("");
+  ep.begin_day(600, 1200);
+  ep.process_events(second);
+  ep.close();
+
+  std::ostringstream fresh_out;
+  event_processor fresh(2, 10, 600, 1200, fresh_out);
+  fresh.process_events(second);
+  fresh.close();
+
+  REQUIRE(out.str() == fresh_out.str());
+  REQUIRE(ep.totals().revenue == 20);
+  REQUIRE(ep.totals().errors == 2);
+}
+
+TEST_CASE("The memory report follows the busiest recent day", "[memory]") {
+  using namespace pc_club;
+  auto day = [](std::int32_t clients) {
+    std::vector<event> events;
+    for (std::int32_t i = 0; i < clients; i++) {
+      std::string name = "client_with_a_long_name_" + std::to_string(i);
+      events.push_back({.time = 600, .type = event_type::enter, .name = name, .table = 0});
+    }
+    return events;
+  };
+  std::ostream discard(nullptr);
+  event_processor ep(3, 10, 540, 1140, discard, output_format::none);
+  const processor_memory empty = ep.memory_report();
+  REQUIRE(empty.tables == 4 * sizeof(table));
+  REQUIRE(empty.table_index == 4 * sizeof(client_index::id));
+  REQUIRE(empty.queue == 3 * sizeof(client_index::id));
+  REQUIRE(empty.client_names == 0);
+
+  ep.process_events(day(1000));
+  ep.close();
+  const processor_memory busy = ep.memory_report();
+  REQUIRE(busy.client_records >= 1000 * sizeof(client_record));
+  REQUIRE(busy.client_names > 1000 * 24);
+  REQUIRE(busy.total() > empty.total());
+
+  ep.begin_day(540, 1140);
+  ep.process_events(day(10));
+  ep.close();
+  const processor_memory quiet = ep.memory_report();
+  REQUIRE(quiet.client_records < busy.client_records / 10);
+  REQUIRE(quiet.name_index < busy.name_index);
+  REQUIRE(quiet.total() < busy.total());
+}
+
+TEST_CASE("A retraction rolls the day back to just before the retracted event", "[retract]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  event_processor ep(1, 10, 540, 1140, out);
+  ep.set_journal(true);
+  ep.process_events(std::vector<event>{
+      {.time = 541, .type = event_type::enter, .name = "a", .table = -1},
+      {.time = 542, .type = event_type::take, .name = "a", .table = 1},
+      {.time = 600, .type = event_type::leave, .name = "a", .table = -1},
+      {.time = 610, .type = event_type::enter, .name = "b", .table = -1},
+      {.time = 611, .type = event_type::take, .name = "b", .table = 1},
+  });
+  out.str("");
+  // "a" never left, so "b" could not have taken the table.
+  ep.process_event({.time = 620, .type = event_type::retract, .name = "a", .table = -1, .target_time = 600});
+  ep.process_event({.time = 630, .type = event_type::leave, .name = "a", .table = -1});
+  ep.close();
+  REQUIRE(out.str() == "10:20 5 a 10:00\n"
+                       "10:30 4 a\n"
+                       "19:00\n"
+                       "1 20 01:28\n");
+  REQUIRE(ep.totals().errors == 1);
+}
+
+TEST_CASE("A retraction without a journal or a matching event is an error", "[retract]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  event_processor ep(1, 10, 540, 1140, out);
+  ep.process_event({.time = 541, .type = event_type::enter, .name = "a", .table = -1});
+  out.str("");
+  ep.process_event({.time = 542, .type = event_type::retract, .name = "a", .table = -1, .target_time = 541});
+  ep.set_journal(true);
+  ep.process_event({.time = 543, .type = event_type::enter, .name = "b", .table = -1});
+  ep.process_event({.time = 544, .type = event_type::retract, .name = "b", .table = -1, .target_time = 542});
+  ep.process_event({.time = 545, .type = event_type::retract, .name = "b", .table = -1, .target_time = 543});
+  ep.process_event({.time = 546, .type = event_type::retract, .name = "b", .table = -1, .target_time = 543});
+  REQUIRE(out.str() == "09:02 5 a 09:01\n"
+                       "09:02 13 NothingToRetract\n"
+                       "09:03 1 b\n"
+                       "09:04 5 b 09:02\n"
+                       "09:04 13 NothingToRetract\n"
+                       "09:05 5 b 09:03\n"
+                       "09:06 5 b 09:03\n"
+                       "09:06 13 NothingToRetract\n");
+  REQUIRE(ep.snapshot().clients == std::vector<std::string>{"a"});
+}
+
+TEST_CASE("Retractions leave the state of a day that never had the retracted events", "[retract]") {
+  using namespace pc_club;
+  std::mt19937 rng(5);
+  std::vector<event> effective;
+  std::ostringstream out;
+  event_processor ep(2, 10, 540, 1140, out);
+  ep.set_journal(true);
+  // Few tables for the clients, so that the queue and its calls are rolled back too.
+  std::int32_t failed = 0;
+  for (std::int32_t time = 530; time < 1100; time++) {
+    event e{};
+    e.time = time;
+    e.name = "c" + std::to_string(rng() % 6);
+    if (rng() % 6 == 0) {
+      // Mostly events that happened, sometimes one that did not.
+      e.type = event_type::retract;
+      e.target_time = rng() % 5 == 0 ? time : std::max(530, time - static_cast<std::int32_t>(rng() % 40));
+      if (rng() % 5 != 0 && !effective.empty()) {
+        const event& target = effective[effective.size() - 1 - rng() % std::min<std::size_t>(effective.size(), 30)];
+        e.name = target.name;
+        e.target_time = target.time;
+      }
+      auto it = std::find_if(effective.rbegin(), effective.rend(), [&](const event& x) {
+        return x.time == e.target_time && x.name == e.name;
+      });
+      if (it == effective.rend()) {
+        failed++;
+      } else {
+        effective.erase(std::next(it).base());
+      }
+    } else {
+      e.type = static_cast<event_type>(1 + rng() % 4);
+      e.table = e.type == event_type::take ? 1 + static_cast<std::int32_t>(rng() % 2) : 0;
+      effective.push_back(e);
+    }
+    ep.process_event(e);
+  }
+
+  std::ostringstream reference_out;
+  event_processor reference(2, 10, 540, 1140, reference_out);
+  reference.process_events(effective);
+  auto state = ep.snapshot();
+  auto expected = reference.snapshot();
+  std::sort(state.clients.begin(), state.clients.end());
+  std::sort(expected.clients.begin(), expected.clients.end());
+  REQUIRE(state.clients == expected.clients);
+  REQUIRE(state.waiting == expected.waiting);
+  REQUIRE(state.seated == expected.seated);
+  REQUIRE(state.tables == expected.tables);
+  REQUIRE(state.turn_aways == expected.turn_aways);
+  REQUIRE(state.errors == expected.errors + failed);
+
+  out.str("");
+  reference_out.str("");
+  ep.close();
+  reference.close();
+  REQUIRE(out.str() == reference_out.str());
+}
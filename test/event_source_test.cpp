@@ -0,0 +1,119 @@
+#include "event_source.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("Buffer and stream sources yield the same lines", "[source]") {
+  std::string text = "3\n09:00 19:00\n10\n\nlast";
+  std::vector<std::string> from_buffer, from_stream;
+  for (std::string_view line : pc_club::read_buffer_lines(text)) {
+    from_buffer.emplace_back(line);
+  }
+  std::istringstream in(text);
+  for (std::string_view line : pc_club::read_lines(in)) {
+    from_stream.emplace_back(line);
+  }
+  REQUIRE(from_buffer == std::vector<std::string>{"3", "09:00 19:00", "10", "", "last"});
+  REQUIRE(from_stream == from_buffer);
+}
+
+TEST_CASE("Header then events are pulled from one source", "[source]") {
+  using namespace pc_club;
+  std::string text = "2\n10:00 12:00\n5\n10:01 1 a\n10:02 2 a 2\n10:03 2 a 3\n10:04 4 a\n";
+  auto lines = read_buffer_lines(text);
+
+  club_parameters club{};
+  std::string bad_header;
+  REQUIRE(read_parameters(lines, club, bad_header));
+  REQUIRE(club.tables == 2);
+  REQUIRE(club.open_time == 600);
+  REQUIRE(club.price == 5);
+
+  std::optional<std::string> bad_line;
+  auto events = parse_events(lines, club.tables, bad_line);
+  std::vector<std::string> names;
+  for (const event& e : events) {
+    names.push_back(std::to_string(static_cast<int>(e.type)));
+  }
+  REQUIRE(names == std::vector<std::string>{"1", "2"});
+  REQUIRE(bad_line == "10:03 2 a 3");
+}
+
+TEST_CASE("Malformed header reports the offending line", "[source]") {
+  auto lines = pc_club::read_buffer_lines("3\n09:00\n10\n");
+  pc_club::club_parameters club{};
+  std::string bad_line;
+  REQUIRE_FALSE(pc_club::read_parameters(lines, club, bad_line));
+  REQUIRE(bad_line == "09:00");
+
+  auto empty = pc_club::read_buffer_lines("");
+  REQUIRE_FALSE(pc_club::read_parameters(empty, club, bad_line));
+  REQUIRE(bad_line.empty());
+}
+
+TEST_CASE("Filtered events stream into a processor", "[source]") {
+  using namespace pc_club;
+  std::string text = "00:00 1 a\n00:00 1 b\n00:00 2 a 1\n00:00 2 b 1\n01:00 4 a\n";
+  auto lines = read_buffer_lines(text);
+  std::optional<std::string> bad_line;
+  auto events = parse_events(lines, 1, bad_line);
+  auto only_a = filter_events(events, [](const event& e) { return e.name == "a"; });
+
+  std::ostringstream oss;
+  auto* old = std::cout.rdbuf(oss.rdbuf());
+  event_processor ep(1, 10, 0, 120);
+  feed(only_a, ep);
+  ep.close();
+  std::cout.rdbuf(old);
+
+  REQUIRE_FALSE(bad_line);
+  REQUIRE(oss.str() == "00:00\n00:00 1 a\n00:00 2 a 1\n01:00 4 a\n02:00\n1 10 01:00\n");
+}
+
+TEST_CASE("Terminal logs merge by time, ties in log order", "[source]") {
+  using namespace pc_club;
+  const std::vector<std::string> texts = {
+      "10:00 1 a\n10:05 1 d\n10:05 1 e\n",
+      "",
+      "10:01 1 b\n10:05 1 f\n11:00 1 g\n",
+      "09:59 1 c\n10:05 1 h\n",
+  };
+  std::vector<line_source> logs;
+  for (const auto& text : texts) {
+    logs.push_back(read_buffer_lines(text));
+  }
+  std::optional<std::string> bad_line;
+  std::vector<generator<event>> parsed;
+  for (auto& log : logs) {
+    parsed.push_back(parse_events(log, 1, bad_line));
+  }
+  std::string order;
+  for (const event& e : merge_events(parsed, bad_line)) {
+    order += e.name;
+  }
+  REQUIRE(order == "cabdefhg");
+  REQUIRE_FALSE(bad_line);
+}
+
+TEST_CASE("Merging stops at a malformed line of any log", "[source]") {
+  using namespace pc_club;
+  std::vector<line_source> logs;
+  logs.push_back(read_buffer_lines("10:00 1 a\n10:10 1 c\n10:20 1 e\n"));
+  logs.push_back(read_buffer_lines("10:05 1 b\n10:06 1 B\n10:30 1 f\n"));
+  std::optional<std::string> bad_line;
+  std::vector<generator<event>> parsed;
+  for (auto& log : logs) {
+    parsed.push_back(parse_events(log, 1, bad_line));
+  }
+  std::string order;
+  for (const event& e : merge_events(parsed, bad_line)) {
+    order += e.name;
+  }
+  REQUIRE(order == "ab");
+  REQUIRE(bad_line == "10:06 1 B");
+}
@@ -0,0 +1,96 @@
+#include "flat_hash_set.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST_CASE("Flat hash set inserts, finds and erases names", "[flat_hash_set]") {
+  using namespace pc_club;
+  flat_hash_set set;
+  REQUIRE_FALSE(set.contains("a", hash_name("a")));
+  REQUIRE_FALSE(set.erase("a", hash_name("a")));
+  REQUIRE(set.insert("a", hash_name("a")));
+  REQUIRE_FALSE(set.insert("a", hash_name("a")));
+  REQUIRE(set.insert("b", hash_name("b")));
+  REQUIRE(set.size() == 2);
+  REQUIRE(set.contains("a", hash_name("a")));
+  REQUIRE(set.erase("a", hash_name("a")));
+  REQUIRE_FALSE(set.contains("a", hash_name("a")));
+  REQUIRE(set.contains("b", hash_name("b")));
+
+  std::vector<std::string> names;
+  set.for_each([&](std::string_view name) { names.emplace_back(name); });
+  REQUIRE(names == std::vector<std::string>{"b"});
+
+  set.clear();
+  REQUIRE(set.size() == 0);
+  REQUIRE_FALSE(set.contains("b", hash_name("b")));
+}
+
+TEST_CASE("Flat hash set tells colliding names apart", "[flat_hash_set]") {
+  pc_club::flat_hash_set set;
+  // Every name in the same group with the same control byte: lookups fall back to comparing names.
+  for (int i = 0; i < 100; i++) {
+    REQUIRE(set.insert("c" + std::to_string(i), 42));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    REQUIRE(set.erase("c" + std::to_string(i), 42));
+  }
+  for (int i = 0; i < 100; i++) {
+    REQUIRE(set.contains("c" + std::to_string(i), 42) == (i % 2 == 1));
+  }
+}
+
+TEST_CASE("Flat hash set matches std::set under churn", "[flat_hash_set]") {
+  using namespace pc_club;
+  flat_hash_set set;
+  std::set<std::string> model;
+  std::mt19937 rng(7);
+  // Few live names and many erasures: tombstones pile up and are cleared by rehashing in place.
+  for (int step = 0; step < 200000; step++) {
+    std::string name = "client_" + std::to_string(rng() % (step < 100000 ? 300 : 40));
+    std::size_t hash = hash_name(name);
+    if (rng() % 2 == 0) {
+      REQUIRE(set.insert(name, hash) == model.insert(name).second);
+    } else {
+      REQUIRE(set.erase(name, hash) == (model.erase(name) == 1));
+    }
+    REQUIRE(set.size() == model.size());
+  }
+  for (int i = 0; i < 300; i++) {
+    std::string name = "client_" + std::to_string(i);
+    REQUIRE(set.contains(name, hash_name(name)) == model.contains(name));
+  }
+  std::vector<std::string> names;
+  set.for_each([&](std::string_view name) { names.emplace_back(name); });
+  std::sort(names.begin(), names.end());
+  REQUIRE(names == std::vector<std::string>(model.begin(), model.end()));
+}
+
+TEST_CASE("Flat hash set gives back storage after a peak", "[flat_hash_set]") {
+  using namespace pc_club;
+  flat_hash_set set;
+  for (int i = 0; i < 1000; i++) {
+    std::string name = "c" + std::to_string(i);
+    set.insert(name, hash_name(name));
+  }
+  const std::size_t peak = set.capacity();
+  set.compact(1000);
+  REQUIRE(set.capacity() == peak);
+
+  for (int i = 10; i < 1000; i++) {
+    std::string name = "c" + std::to_string(i);
+    set.erase(name, hash_name(name));
+  }
+  set.compact(0);
+  REQUIRE(set.capacity() == 16);
+  REQUIRE(set.size() == 10);
+  for (int i = 0; i < 1000; i++) {
+    std::string name = "c" + std::to_string(i);
+    REQUIRE(set.contains(name, hash_name(name)) == (i < 10));
+  }
+}
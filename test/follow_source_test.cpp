@@ -0,0 +1,87 @@
+#include "follow_source.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+
+TEST_CASE("Follow yields appended lines until the file is removed", "[follow]") {
+  auto path = std::filesystem::temp_directory_path() / "pc_club_follow_test.txt";
+  {
+    std::ofstream out(path);
+    out << "first\nsec";
+  }
+  pc_club::follow_options options;
+  auto lines = pc_club::follow_file_lines(path.string(), options);
+
+  REQUIRE(lines.next());
+  REQUIRE(lines.value() == "first");
+
+  std::thread writer([&path] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    {
+      std::ofstream out(path, std::ios::app);
+      out << "ond\nthird\n" << std::flush;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::filesystem::remove(path);
+  });
+
+  std::vector<std::string> rest;
+  while (lines.next()) {
+    rest.emplace_back(lines.value());
+  }
+  writer.join();
+  REQUIRE(rest == std::vector<std::string>{"second", "third"});
+}
+
+TEST_CASE("Follow stops waiting at the deadline", "[follow]") {
+  auto path = std::filesystem::temp_directory_path() / "pc_club_follow_deadline_test.txt";
+  {
+    std::ofstream out(path);
+    out << "only\n";
+  }
+  pc_club::follow_options options;
+  options.deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(50);
+  std::vector<std::string> got;
+  for (std::string_view line : pc_club::follow_file_lines(path.string(), options)) {
+    got.emplace_back(line);
+  }
+  std::filesystem::remove(path);
+  REQUIRE(got == std::vector<std::string>{"only"});
+}
+
+TEST_CASE("Follow reads a pipe on stdin until its writer closes", "[follow]") {
+  int fds[2];
+  REQUIRE(::pipe(fds) == 0);
+  int saved_stdin = ::dup(STDIN_FILENO);
+  REQUIRE(::dup2(fds[0], STDIN_FILENO) == STDIN_FILENO);
+  ::close(fds[0]);
+
+  pc_club::follow_options options;
+  auto lines = pc_club::follow_file_lines("-", options);
+
+  std::thread writer([fd = fds[1]] {
+    ::write(fd, "3\n09:00 ", 8);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ::write(fd, "19:00\n10\n", 9);
+    ::close(fd);
+  });
+
+  std::vector<std::string> got;
+  while (lines.next()) {
+    got.emplace_back(lines.value());
+  }
+  writer.join();
+  ::dup2(saved_stdin, STDIN_FILENO);
+  ::close(saved_stdin);
+  REQUIRE(got == std::vector<std::string>{"3", "09:00 19:00", "10"});
+}
+#endif
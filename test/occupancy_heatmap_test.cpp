@@ -0,0 +1,138 @@
+#include "event_processor.h"
+#include "occupancy_heatmap.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("Seating intervals become per-minute counts", "[heatmap]") {
+  pc_club::occupancy_heatmap heatmap(3);
+  heatmap.record(1, 10, 20);
+  heatmap.record(1, 20, 25);
+  heatmap.record(2, 15, 16);
+  heatmap.record(3, 1430, 1440);
+  heatmap.finish();
+
+  REQUIRE(heatmap.occupancy(1, 9) == 0);
+  REQUIRE(heatmap.occupancy(1, 10) == 1);
+  REQUIRE(heatmap.occupancy(1, 24) == 1);
+  REQUIRE(heatmap.occupancy(1, 25) == 0);
+  REQUIRE(heatmap.occupancy(2, 15) == 1);
+  REQUIRE(heatmap.occupancy(2, 16) == 0);
+  REQUIRE(heatmap.occupancy(3, 1439) == 1);
+  REQUIRE(heatmap.club(15) == 2);
+  REQUIRE(heatmap.club(16) == 1);
+  REQUIRE(heatmap.club(1435) == 1);
+
+  // Finishing again after more records accounts for everything recorded.
+  heatmap.record(2, 0, 1440);
+  heatmap.finish();
+  REQUIRE(heatmap.occupancy(2, 15) == 2);
+  REQUIRE(heatmap.club(0) == 1);
+
+  REQUIRE_THROWS_AS(pc_club::occupancy_heatmap(0), std::invalid_argument);
+}
+
+TEST_CASE("Heatmap of a day adds up to the tables' usage", "[heatmap]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  occupancy_heatmap heatmap(3);
+  event_processor ep(3, 10, 540, 1140, out);
+  ep.set_heatmap(&heatmap);
+  ep.process_event({.time = 541, .type = event_type::enter, .name = "a", .table = 0});
+  ep.process_event({.time = 541, .type = event_type::enter, .name = "b", .table = 0});
+  ep.process_event({.time = 542, .type = event_type::take, .name = "a", .table = 1});
+  ep.process_event({.time = 600, .type = event_type::take, .name = "a", .table = 2});
+  ep.process_event({.time = 610, .type = event_type::take, .name = "b", .table = 3});
+  ep.process_event({.time = 700, .type = event_type::leave, .name = "a", .table = 0});
+  ep.close();
+
+  REQUIRE(heatmap.occupancy(1, 541) == 0);
+  REQUIRE(heatmap.occupancy(1, 542) == 1);
+  REQUIRE(heatmap.occupancy(1, 600) == 0);
+  REQUIRE(heatmap.occupancy(2, 600) == 1);
+  REQUIRE(heatmap.occupancy(3, 1139) == 1);
+  REQUIRE(heatmap.occupancy(3, 1140) == 0);
+  REQUIRE(heatmap.club(650) == 2);
+  for (std::int32_t t = 1; t <= 3; t++) {
+    std::int32_t minutes = 0;
+    for (std::int32_t m = 0; m < occupancy_heatmap::minutes; m++) {
+      minutes += heatmap.occupancy(t, m);
+    }
+    REQUIRE(minutes == ep.snapshot().tables[static_cast<std::size_t>(t - 1)].usage);
+  }
+}
+
+TEST_CASE("Heatmap clips intervals and skips empty ones", "[heatmap]") {
+  pc_club::occupancy_heatmap heatmap(2);
+  heatmap.record(1, 30, 20);
+  heatmap.record(1, 40, 40);
+  heatmap.record(2, -5, 2);
+  heatmap.record(2, 1438, 1500);
+  heatmap.finish();
+
+  for (std::int32_t m = 0; m < pc_club::occupancy_heatmap::minutes; m++) {
+    REQUIRE(heatmap.occupancy(1, m) == 0);
+  }
+  REQUIRE(heatmap.occupancy(2, 0) == 1);
+  REQUIRE(heatmap.occupancy(2, 2) == 0);
+  REQUIRE(heatmap.occupancy(2, 1439) == 1);
+  REQUIRE(heatmap.club(1437) == 0);
+}
+
+TEST_CASE("Heatmap covers only the opening hours", "[heatmap]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  occupancy_heatmap heatmap(2);
+  event_processor ep(2, 10, 540, 600, out);
+  ep.set_heatmap(&heatmap);
+  ep.process_event({.time = 590, .type = event_type::enter, .name = "a", .table = 0});
+  ep.process_event({.time = 590, .type = event_type::take, .name = "a", .table = 1});
+  // Taken after the close time: the table's usage goes negative and nothing is drawn for it.
+  ep.process_event({.time = 620, .type = event_type::enter, .name = "b", .table = 0});
+  ep.process_event({.time = 620, .type = event_type::take, .name = "b", .table = 2});
+  ep.process_event({.time = 630, .type = event_type::leave, .name = "a", .table = 0});
+  ep.close();
+
+  REQUIRE(heatmap.occupancy(1, 599) == 1);
+  REQUIRE(heatmap.occupancy(1, 600) == 0);
+  REQUIRE(heatmap.occupancy(1, 629) == 0);
+  for (std::int32_t m = 0; m < occupancy_heatmap::minutes; m++) {
+    REQUIRE(heatmap.occupancy(2, m) == 0);
+    REQUIRE(heatmap.club(m) >= 0);
+  }
+}
+
+TEST_CASE("Heatmap exports CSV and binary", "[heatmap]") {
+  pc_club::occupancy_heatmap heatmap(2);
+  heatmap.record(2, 1, 3);
+  heatmap.finish();
+
+  std::ostringstream csv;
+  heatmap.write_csv(csv);
+  std::istringstream rows(csv.str());
+  std::string line;
+  std::getline(rows, line);
+  REQUIRE(line == "minute,club,1,2");
+  std::getline(rows, line);
+  REQUIRE(line == "0,0,0,0");
+  std::getline(rows, line);
+  REQUIRE(line == "1,1,0,1");
+
+  std::ostringstream binary;
+  heatmap.write_binary(binary);
+  const std::string bytes = binary.str();
+  REQUIRE(bytes.size() == (1 + 1440 * 3) * 4);
+  auto at = [&bytes](std::size_t i) {
+    std::int32_t value = 0;
+    std::memcpy(&value, bytes.data() + i * 4, 4);
+    return value;
+  };
+  REQUIRE(at(0) == 2);
+  REQUIRE(at(1 + 2 * 3) == 1);
+  REQUIRE(at(1 + 2 * 3 + 2) == 1);
+  REQUIRE(at(1 + 3 * 3) == 0);
+}
@@ -0,0 +1,177 @@
+#include "event_processor.h"
+#include "output_encoder.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+std::string run_club(pc_club::output_format format) {
+  using namespace pc_club;
+  std::ostringstream out;
+  event_processor ep(2, 10, 540, 600, out, format);
+  ep.process_event({.time = 541, .type = event_type::enter, .name = "alice", .table = 0});
+  ep.process_event({.time = 542, .type = event_type::take, .name = "alice", .table = 2});
+  ep.process_event({.time = 543, .type = event_type::take, .name = "bob", .table = 1});
+  ep.close();
+  return out.str();
+}
+} // namespace
+
+TEST_CASE("Text encoding keeps the task output format", "[output_encoder]") {
+  REQUIRE(
+      run_club(pc_club::output_format::text) == "09:00\n"
+                                                "09:01 1 alice\n"
+                                                "09:02 2 alice 2\n"
+                                                "09:03 2 bob 1\n"
+                                                "09:03 13 ClientUnknown\n"
+                                                "10:00\n"
+                                                "1 0 00:00\n"
+                                                "2 10 00:58\n"
+  );
+}
+
+TEST_CASE("Text encoding prints the usage of a table taken after the close time as printf did", "[output_encoder]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  event_processor ep(3, 10, 540, 600, out, output_format::text);
+  ep.process_event({.time = 541, .type = event_type::enter, .name = "alice", .table = 0});
+  ep.process_event({.time = 541, .type = event_type::take, .name = "alice", .table = 1});
+  ep.process_event({.time = 625, .type = event_type::enter, .name = "carol", .table = 0});
+  ep.process_event({.time = 625, .type = event_type::take, .name = "carol", .table = 3});
+  ep.process_event({.time = 665, .type = event_type::enter, .name = "bob", .table = 0});
+  ep.process_event({.time = 665, .type = event_type::take, .name = "bob", .table = 2});
+  ep.close();
+  REQUIRE(
+      out.str() == "09:00\n"
+                   "09:01 1 alice\n"
+                   "09:01 2 alice 1\n"
+                   "10:25 1 carol\n"
+                   "10:25 2 carol 3\n"
+                   "11:05 1 bob\n"
+                   "11:05 2 bob 2\n"
+                   "10:00\n"
+                   "1 10 00:59\n"
+                   "2 0 -1:-5\n"
+                   "3 0 00:-2\n"
+  );
+}
+
+TEST_CASE("CSV encoding writes one row per record", "[output_encoder]") {
+  std::string out;
+  pc_club::output_encoder encoder(pc_club::output_format::csv);
+  encoder.begin(out);
+  REQUIRE(out == "record,time,id,name,table,revenue,usage\n");
+
+  REQUIRE(
+      run_club(pc_club::output_format::csv) == "open,540,,,,,\n"
+                                               "event,541,1,alice,,,\n"
+                                               "event,542,2,alice,2,,\n"
+                                               "event,543,2,bob,1,,\n"
+                                               "event,543,13,ClientUnknown,,,\n"
+                                               "close,600,,,,,\n"
+                                               "table,,,,1,0,0\n"
+                                               "table,,,,2,10,58\n"
+  );
+
+  out.clear();
+  encoder.input_error(out, R"(09:00 1 "a,b")");
+  REQUIRE(out == "input_error,,,\"09:00 1 \"\"a,b\"\"\",,,\n");
+}
+
+TEST_CASE("JSON Lines encoding omits empty fields and escapes strings", "[output_encoder]") {
+  auto out = run_club(pc_club::output_format::jsonl);
+  std::istringstream lines(out);
+  std::string first, second, third;
+  std::getline(lines, first);
+  std::getline(lines, second);
+  std::getline(lines, third);
+  REQUIRE(first == R"({"record":"open","time":540})");
+  REQUIRE(second == R"({"record":"event","time":541,"id":1,"name":"alice"})");
+  REQUIRE(third == R"({"record":"event","time":542,"id":2,"name":"alice","table":2})");
+  REQUIRE(out.ends_with(R"({"record":"table","table":2,"revenue":10,"usage":58})"
+                        "\n"));
+
+  std::string error;
+  pc_club::output_encoder(pc_club::output_format::jsonl).input_error(error, "a\"b\\c\t");
+  REQUIRE(error == R"({"record":"input_error","line":"a\"b\\c\u0009"})"
+                   "\n");
+}
+
+TEST_CASE("Binary encoding is a stream of fixed-width records", "[output_encoder]") {
+  using namespace pc_club;
+  auto out = run_club(output_format::binary);
+  REQUIRE(out.size() == 8 * sizeof(binary_record));
+
+  // Copy into aligned storage, as a reader of a file or an mmap-ed region would have it.
+  std::vector<binary_record> storage(out.size() / sizeof(binary_record));
+  std::memcpy(storage.data(), out.data(), out.size());
+  auto records = binary_records(std::as_bytes(std::span(storage)));
+  REQUIRE(records.size() == 8);
+
+  REQUIRE(records[0].kind == record_kind::open);
+  REQUIRE(records[0].time == 540);
+  REQUIRE(records[2].kind == record_kind::event);
+  REQUIRE(records[2].id == 2);
+  REQUIRE(records[2].table == 2);
+  REQUIRE(std::string_view(records[2].name, records[2].name_size) == "alice");
+  REQUIRE(records[4].id == 13);
+  REQUIRE(std::string_view(records[4].name, records[4].name_size) == "ClientUnknown");
+  REQUIRE(records[7].kind == record_kind::table);
+  REQUIRE(records[7].table == 2);
+  REQUIRE(records[7].revenue == 10);
+  REQUIRE(records[7].usage == 58);
+  REQUIRE(records[0].name_size == 0);
+  REQUIRE(records[0].name[0] == '\0');
+
+  std::string long_name(70, 'x');
+  long_name[69] = 'y';
+  std::string buffer;
+  output_encoder(output_format::binary).event(buffer, 600, 1, long_name);
+  REQUIRE(buffer.size() == 3 * sizeof(binary_record));
+  std::vector<binary_record> chained(3);
+  std::memcpy(chained.data(), buffer.data(), buffer.size());
+  REQUIRE(chained[0].name_size == 70);
+  REQUIRE(chained[1].kind == record_kind::continuation);
+  REQUIRE(chained[2].kind == record_kind::continuation);
+  REQUIRE(chained[2].name_size == 6);
+  REQUIRE(std::string_view(chained[2].name, 6) == "xxxxxy");
+}
+
+TEST_CASE("A retraction is echoed with the time it takes back", "[output_encoder]") {
+  using namespace pc_club;
+  auto encode = [](output_format format) {
+    std::string out;
+    output_encoder(format).retraction(out, 1145, "alice", 1142);
+    return out;
+  };
+  REQUIRE(encode(output_format::text) == "19:05 5 alice 19:02\n");
+  REQUIRE(encode(output_format::csv) == "event,1145,5,alice,,,1142\n");
+  REQUIRE(encode(output_format::jsonl) == R"({"record":"event","time":1145,"id":5,"name":"alice","target_time":1142})"
+                                          "\n");
+  binary_record record;
+  auto binary = encode(output_format::binary);
+  REQUIRE(binary.size() == sizeof(record));
+  std::memcpy(&record, binary.data(), sizeof(record));
+  REQUIRE(record.id == 5);
+  REQUIRE(record.time == 1145);
+  REQUIRE(record.usage == 1142);
+}
+
+TEST_CASE("No output is written in the none format", "[output_encoder]") {
+  REQUIRE(run_club(pc_club::output_format::none).empty());
+}
+
+TEST_CASE("Output formats are parsed by name", "[output_encoder]") {
+  pc_club::output_format format{};
+  REQUIRE(pc_club::parse_output_format("jsonl", format));
+  REQUIRE(format == pc_club::output_format::jsonl);
+  REQUIRE(pc_club::parse_output_format("binary", format));
+  REQUIRE(format == pc_club::output_format::binary);
+  REQUIRE(pc_club::parse_output_format("none", format));
+  REQUIRE(format == pc_club::output_format::none);
+  REQUIRE_FALSE(pc_club::parse_output_format("xml", format));
+}
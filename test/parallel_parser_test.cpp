@@ -0,0 +1,91 @@
+#include "event_source.h"
+#include "parallel_parser.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+std::string make_section(std::size_t lines) {
+  std::string text;
+  for (std::size_t i = 0; i < lines; i++) {
+    std::int32_t minutes = 600 + static_cast<std::int32_t>(i % 600);
+    char time[6] = {
+        static_cast<char>('0' + minutes / 600),
+        static_cast<char>('0' + minutes / 60 % 10),
+        ':',
+        static_cast<char>('0' + minutes % 60 / 10),
+        static_cast<char>('0' + minutes % 10),
+        '\0'
+    };
+    text += time;
+    text += i % 4 == 1 ? " 2 client" + std::to_string(i % 50) + ' ' + std::to_string(1 + i % 3)
+                       : ' ' + std::to_string(i % 4 == 0 ? 1 : i % 4 + 1) + " client" + std::to_string(i % 50);
+    text += '\n';
+  }
+  return text;
+}
+
+std::vector<pc_club::event> parse_sequential(std::string_view section, std::optional<std::string>& bad_line) {
+  std::vector<pc_club::event> events;
+  auto lines = pc_club::read_buffer_lines(section);
+  for (const auto& e : pc_club::parse_events(lines, 3, bad_line)) {
+    events.push_back(e);
+  }
+  return events;
+}
+
+bool same_events(const std::vector<pc_club::event>& a, const std::vector<pc_club::event>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const pc_club::event& x, const pc_club::event& y) {
+    return x.time == y.time && x.type == y.type && x.name == y.name && x.table == y.table;
+  });
+}
+
+constexpr pc_club::parallel_parse_options small_chunks{.threads = 4, .min_chunk = 64};
+} // namespace
+
+TEST_CASE("Parallel parsing matches sequential parsing", "[parallel_parser]") {
+  for (std::string section : {make_section(1000), make_section(3), std::string(), make_section(10) + "10:00 1 last"}) {
+    std::optional<std::string> sequential_bad, parallel_bad;
+    auto expected = parse_sequential(section, sequential_bad);
+    auto actual = pc_club::parse_events_parallel(section, 3, parallel_bad, small_chunks);
+    REQUIRE_FALSE(parallel_bad);
+    REQUIRE_FALSE(sequential_bad);
+    REQUIRE(same_events(actual, expected));
+  }
+}
+
+TEST_CASE("Parallel parsing reports the first malformed line", "[parallel_parser]") {
+  std::string section = make_section(400);
+  std::string tail = make_section(400);
+  section += "10:00 9 early\n" + make_section(400) + "bad line\n" + tail + "\n" + tail;
+
+  std::optional<std::string> sequential_bad, parallel_bad;
+  auto expected = parse_sequential(section, sequential_bad);
+  auto actual = pc_club::parse_events_parallel(section, 3, parallel_bad, small_chunks);
+  REQUIRE(parallel_bad == "10:00 9 early");
+  REQUIRE(parallel_bad == sequential_bad);
+  REQUIRE(actual.size() == 400);
+  REQUIRE(same_events(actual, expected));
+
+  std::optional<std::string> empty_line;
+  pc_club::parse_events_parallel(make_section(300) + "\n" + make_section(300), 3, empty_line, small_chunks);
+  REQUIRE(empty_line == "");
+}
+
+TEST_CASE("In-memory header leaves the event section", "[parallel_parser]") {
+  std::string_view input = "3\n09:00 19:00\n10\n09:10 1 a\n";
+  pc_club::club_parameters club{};
+  std::string bad_line;
+  REQUIRE(pc_club::read_parameters(input, club, bad_line));
+  REQUIRE(club.tables == 3);
+  REQUIRE(club.price == 10);
+  REQUIRE(input == "09:10 1 a\n");
+
+  std::string_view bad = "3\n09:00\n10\n";
+  REQUIRE_FALSE(pc_club::read_parameters(bad, club, bad_line));
+  REQUIRE(bad_line == "09:00");
+}
@@ -0,0 +1,60 @@
+#include "parallel_replay.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr pc_club::club_parameters club{.tables = 5, .price = 10, .open_time = 540, .close_time = 1140};
+
+// Clients enter, sit, move, queue and leave at random, with some of them still inside at closing.
+std::vector<pc_club::event> make_day(std::size_t count) {
+  std::mt19937 rng(11);
+  std::vector<pc_club::event> events;
+  for (std::size_t i = 0; i < count; i++) {
+    pc_club::event e{};
+    e.time = 500 + static_cast<std::int32_t>(i * 700 / count);
+    e.type = static_cast<pc_club::event_type>(1 + rng() % 4);
+    e.name = "client" + std::to_string(rng() % 20);
+    e.name_hash = pc_club::hash_name(e.name);
+    e.table = e.type == pc_club::event_type::take ? 1 + static_cast<std::int32_t>(rng() % club.tables) : 0;
+    events.push_back(std::move(e));
+  }
+  return events;
+}
+
+std::string sequential(const std::vector<pc_club::event>& events, pc_club::output_format format) {
+  std::ostringstream out;
+  pc_club::event_processor ep(club.tables, club.price, club.open_time, club.close_time, out, format);
+  for (const auto& e : events) {
+    ep.process_event(e);
+  }
+  ep.close();
+  return out.str();
+}
+} // namespace
+
+TEST_CASE("Parallel replay matches a sequential run byte for byte", "[parallel_replay]") {
+  using namespace pc_club;
+  for (std::size_t count : {0, 1, 7, 1000, 5003}) {
+    auto events = make_day(count);
+    for (output_format format : {output_format::text, output_format::csv, output_format::binary}) {
+      for (unsigned threads : {1u, 2u, 3u, 8u}) {
+        std::ostringstream out;
+        replay_parallel(events, club, out, format, {.threads = threads, .min_segment = 10});
+        REQUIRE(out.str() == sequential(events, format));
+      }
+    }
+  }
+}
+
+TEST_CASE("Parallel replay runs a short day in one segment", "[parallel_replay]") {
+  using namespace pc_club;
+  auto events = make_day(100);
+  std::ostringstream out;
+  replay_parallel(events, club, out, output_format::text, {.threads = 4, .min_segment = 1000});
+  REQUIRE(out.str() == sequential(events, output_format::text));
+}
@@ -0,0 +1,125 @@
+#include "event_processor.h"
+#include "seating_snapshot.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Published seating follows the processor and never changes", "[seating]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  seating_publisher publisher;
+  event_processor ep(2, 10, 540, 1140, out);
+  REQUIRE(publisher.snapshot() == nullptr);
+  ep.set_seating(&publisher);
+
+  ep.process_event({.time = 541, .type = event_type::enter, .name = "a", .table = 0});
+  auto empty = publisher.snapshot();
+  REQUIRE(empty);
+  REQUIRE(empty->at(1).empty());
+  REQUIRE(empty->at(2).empty());
+
+  ep.process_event({.time = 542, .type = event_type::take, .name = "a", .table = 2});
+  auto seated = publisher.snapshot();
+  REQUIRE(seated->version > empty->version);
+  REQUIRE(seated->time == 542);
+  REQUIRE(seated->at(2) == "a");
+
+  // Nothing about the seating changed: nothing is published.
+  ep.process_event({.time = 543, .type = event_type::enter, .name = "b", .table = 0});
+  REQUIRE(publisher.snapshot() == seated);
+
+  ep.process_event({.time = 544, .type = event_type::take, .name = "a", .table = 1});
+  ep.process_event({.time = 545, .type = event_type::take, .name = "b", .table = 2});
+  auto moved = publisher.snapshot();
+  REQUIRE(moved->at(1) == "a");
+  REQUIRE(moved->at(2) == "b");
+  // Snapshots held by readers are left alone.
+  REQUIRE(seated->at(1).empty());
+  REQUIRE(seated->at(2) == "a");
+  REQUIRE(empty->at(2).empty());
+
+  ep.close();
+  auto closed = publisher.snapshot();
+  REQUIRE(closed->time == 1140);
+  REQUIRE(closed->at(1).empty());
+  REQUIRE(closed->at(2).empty());
+}
+
+TEST_CASE("Released seating snapshots are refilled", "[seating]") {
+  using namespace pc_club;
+  seating_publisher publisher;
+  std::vector<const seating*> published;
+  for (std::int32_t i = 0; i < 4; i++) {
+    seating& next = publisher.prepare(1);
+    next.names[0] = "client_" + std::to_string(i);
+    publisher.publish(i);
+    published.push_back(publisher.snapshot().get());
+  }
+  // Without readers two snapshots alternate: the published one and the one being filled.
+  REQUIRE(published[0] != published[1]);
+  REQUIRE(published[2] == published[0]);
+  REQUIRE(published[3] == published[1]);
+  REQUIRE(publisher.snapshot()->names[0] == "client_3");
+  REQUIRE(publisher.snapshot()->version == 4);
+
+  // A snapshot a reader holds is not refilled.
+  auto held = publisher.snapshot();
+  publisher.prepare(1).names[0] = "client_4";
+  publisher.publish(4);
+  publisher.prepare(1).names[0] = "client_5";
+  publisher.publish(5);
+  REQUIRE(held->names[0] == "client_3");
+  REQUIRE(publisher.snapshot()->names[0] == "client_5");
+}
+
+TEST_CASE("Readers iterate seating while the processor runs", "[seating]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  seating_publisher publisher;
+  event_processor ep(4, 10, 0, 1439, out);
+  ep.set_seating(&publisher);
+
+  // Assertions stay on the test's thread; the reader only counts what it saw.
+  std::atomic<bool> done = false;
+  std::size_t inconsistent = 0;
+  std::jthread reader([&] {
+    std::uint64_t last_version = 0;
+    while (!done.load()) {
+      auto view = publisher.snapshot();
+      if (!view) {
+        continue;
+      }
+      std::set<std::string> names;
+      bool ok = view->version >= last_version && view->names.size() == 4;
+      for (const auto& name : view->names) {
+        ok = ok && (name.empty() || names.insert(name).second);
+      }
+      last_version = view->version;
+      inconsistent += ok ? 0 : 1;
+    }
+  });
+
+  std::mt19937 rng(3);
+  std::vector<event> batch;
+  for (std::int32_t minute = 0; minute < 1439; minute++) {
+    batch.clear();
+    for (int i = 0; i < 8; i++) {
+      auto type = static_cast<event_type>(1 + rng() % 4);
+      std::int32_t table = type == event_type::take ? 1 + static_cast<std::int32_t>(rng() % 4) : 0;
+      batch.push_back({.time = minute, .type = type, .name = "c" + std::to_string(rng() % 10), .table = table});
+    }
+    ep.process_events(batch);
+  }
+  ep.close();
+  done = true;
+  reader.join();
+  REQUIRE(inconsistent == 0);
+  REQUIRE(publisher.snapshot()->names == std::vector<std::string>(4));
+}
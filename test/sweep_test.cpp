@@ -0,0 +1,77 @@
+#include "event_source.h"
+#include "sweep.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+const char* day = "3\n"
+                  "09:00 19:00\n"
+                  "10\n"
+                  "08:48 1 client1\n"
+                  "09:41 1 client1\n"
+                  "09:48 1 client2\n"
+                  "09:52 3 client1\n"
+                  "09:54 2 client1 1\n"
+                  "10:25 2 client2 2\n"
+                  "10:58 1 client3\n"
+                  "10:59 2 client3 3\n"
+                  "11:30 1 client4\n"
+                  "11:35 2 client4 2\n"
+                  "11:45 3 client4\n"
+                  "12:33 4 client1\n"
+                  "12:43 4 client2\n"
+                  "15:52 4 client4\n";
+
+std::vector<pc_club::event> parse_day(pc_club::club_parameters& club) {
+  auto lines = pc_club::read_buffer_lines(day);
+  std::string bad_header;
+  REQUIRE(pc_club::read_parameters(lines, club, bad_header));
+  std::optional<std::string> bad_line;
+  std::vector<pc_club::event> events;
+  for (const auto& e : pc_club::parse_events(lines, club.tables, bad_line)) {
+    events.push_back(e);
+  }
+  REQUIRE_FALSE(bad_line);
+  return events;
+}
+} // namespace
+
+TEST_CASE("Sweep results match separate runs of each configuration", "[sweep]") {
+  using namespace pc_club;
+  club_parameters club{};
+  auto events = parse_day(club);
+  std::vector<sweep_config> configs = {{3, 10}, {3, 25}, {4, 10}, {6, 7}, {20, 100}};
+  auto results = run_sweep(events, club, configs, 3);
+  REQUIRE(results.size() == configs.size());
+
+  for (std::size_t i = 0; i < configs.size(); i++) {
+    std::ostringstream out;
+    event_processor ep(configs[i].tables, configs[i].price, club.open_time, club.close_time, out);
+    ep.process_events(events);
+    ep.close();
+    day_totals expected = ep.totals();
+    REQUIRE(results[i].config.tables == configs[i].tables);
+    REQUIRE(results[i].config.price == configs[i].price);
+    REQUIRE(results[i].totals.revenue == expected.revenue);
+    REQUIRE(results[i].totals.usage == expected.usage);
+    REQUIRE(results[i].totals.turn_aways == expected.turn_aways);
+    REQUIRE(results[i].totals.errors == expected.errors);
+  }
+  REQUIRE(results[0].totals.revenue == 190);
+  REQUIRE(results[0].totals.errors == 3);
+}
+
+TEST_CASE("Sweep rejects configurations the day cannot be replayed under", "[sweep]") {
+  using namespace pc_club;
+  club_parameters club{};
+  auto events = parse_day(club);
+  std::vector<sweep_config> fewer = {{2, 10}};
+  REQUIRE_THROWS_AS(run_sweep(events, club, fewer), std::invalid_argument);
+  REQUIRE(run_sweep(events, club, {}).empty());
+}
@@ -0,0 +1,134 @@
+#include "event_parser.h"
+#include "event_processor.h"
+#include "time_index.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+const std::string day = "2\n"
+                        "09:00 19:00\n"
+                        "10\n"
+                        "09:01 1 a\n"
+                        "09:02 1 b\n"
+                        "09:03 1 c\n"
+                        "09:05 2 a 1\n"
+                        "09:40 2 b 2\n"
+                        "10:10 3 c\n"
+                        "10:15 3 c\n"
+                        "11:20 4 a\n"
+                        "12:00 2 b 1\n"
+                        "13:30 4 b\n"
+                        "18:00 4 c\n";
+
+// Output of the day from the first event at `from` on, replayed from `resume` (or from the start).
+std::string replay(const pc_club::checkpoint* resume, std::int32_t from) {
+  using namespace pc_club;
+  std::ostringstream discard, out;
+  event_processor ep(2, 10, 540, 1140, discard, output_format::none);
+  std::string_view section = std::string_view(day).substr(day.find("09:01"));
+  if (resume) {
+    ep.restore(resume->state);
+    section = std::string_view(day).substr(resume->offset);
+  }
+  bool live = false;
+  event e{};
+  while (!section.empty()) {
+    std::size_t end = section.find('\n');
+    REQUIRE(parse_event(section.substr(0, end), 2, e));
+    section.remove_prefix(end + 1);
+    if (!live && e.time >= from) {
+      ep.set_output(out, output_format::text);
+      live = true;
+    }
+    ep.process_event(e);
+  }
+  ep.close();
+  return out.str();
+}
+} // namespace
+
+TEST_CASE("Checkpoints resume the day with the same output", "[time_index]") {
+  using namespace pc_club;
+  time_index index;
+  std::string bad_line;
+  REQUIRE(build_time_index(day, 60, index, bad_line));
+  REQUIRE(index.header == "2\n09:00 19:00\n10\n");
+  REQUIRE(index.input_size == day.size());
+  REQUIRE(index.checkpoints.size() == 6);
+  REQUIRE(index.find(8 * 60) == &index.checkpoints[0]);
+  REQUIRE(index.find(12 * 60 + 30)->minute == 12 * 60);
+  REQUIRE(index.checkpoints[0].offset == index.header.size());
+
+  for (std::int32_t from = 0; from < 24 * 60; from += 17) {
+    REQUIRE(replay(index.find(from), from) == replay(nullptr, from));
+  }
+}
+
+TEST_CASE("Index survives a round trip through its file format", "[time_index]") {
+  using namespace pc_club;
+  time_index index;
+  std::string bad_line;
+  REQUIRE(build_time_index(day, 30, index, bad_line));
+
+  std::stringstream file;
+  write_time_index(file, index);
+  auto loaded = read_time_index(file);
+  REQUIRE(loaded);
+  REQUIRE(loaded->header == index.header);
+  REQUIRE(loaded->checkpoints.size() == index.checkpoints.size());
+  for (std::int32_t from = 0; from < 24 * 60; from += 29) {
+    REQUIRE(replay(loaded->find(from), from) == replay(index.find(from), from));
+  }
+
+  std::istringstream truncated(file.str().substr(0, file.str().size() / 2));
+  REQUIRE_FALSE(read_time_index(truncated));
+  std::istringstream other("something else\n");
+  REQUIRE_FALSE(read_time_index(other));
+}
+
+TEST_CASE("A corrupt index is rejected without trusting its counts", "[time_index]") {
+  using namespace pc_club;
+  auto read = [](const std::string& text) {
+    std::istringstream in(text);
+    return read_time_index(in).has_value();
+  };
+  const std::string header = "pc_club-index 2\ninput 20\nheader 5\n2\n10\n";
+  const std::string state = "tables 0\nclients 0\nwaiting 0\nseated 0\ncounters 0 0\n";
+  REQUIRE(read(header + "checkpoints 1\ncheckpoint 0 5\n" + state));
+
+  // Counts far beyond what the file holds fail where the data ends.
+  REQUIRE_FALSE(read("pc_club-index 2\ninput 20\nheader 99999999999\n2\n"));
+  REQUIRE_FALSE(read(header + "checkpoints 99999999999\ncheckpoint 0 5\n" + state));
+  REQUIRE_FALSE(read(header + "checkpoints 1\ncheckpoint 0 5\ntables 99999999999\n0 0\n"));
+  REQUIRE_FALSE(read(header + "checkpoints 1\ncheckpoint 0 5\ntables 0\nclients 99999999999 a\n"));
+  // Offsets outside the events of the input, and checkpoints out of order.
+  REQUIRE_FALSE(read(header + "checkpoints 1\ncheckpoint 0 21\n" + state));
+  REQUIRE_FALSE(read(header + "checkpoints 1\ncheckpoint 0 4\n" + state));
+  REQUIRE_FALSE(read(header + "checkpoints 2\ncheckpoint 60 5\n" + state + "checkpoint 0 5\n" + state));
+}
+
+TEST_CASE("Snapshots restore only into a processor of the same club", "[time_index]") {
+  using namespace pc_club;
+  std::ostringstream out;
+  event_processor ep(2, 10, 540, 1140, out);
+  ep.process_event({.time = 541, .type = event_type::enter, .name = "a", .table = 0});
+  ep.process_event({.time = 542, .type = event_type::take, .name = "a", .table = 2});
+  auto state = ep.snapshot();
+  REQUIRE(state.seated == std::vector<processor_state::seat>{{"a", 2, 542}});
+
+  event_processor bigger(3, 10, 540, 1140, out);
+  REQUIRE_THROWS_AS(bigger.restore(state), std::invalid_argument);
+
+  basic_event_processor<fixed_layout<3, 10>> fixed(3, 10, 540, 1140, out);
+  REQUIRE_THROWS_AS(fixed.restore(state), std::invalid_argument);
+
+  std::string bad_line;
+  time_index index;
+  REQUIRE_FALSE(build_time_index("2\n09:00 19:00\n10\n09:01 1 a\nbroken\n", 60, index, bad_line));
+  REQUIRE(bad_line == "broken");
+}
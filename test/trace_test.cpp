@@ -0,0 +1,42 @@
+#include "trace.h"
+
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+TEST_CASE("Sampling keeps every n-th call", "[trace]") {
+  pc_club::trace_recorder recorder(3);
+  std::string pattern;
+  for (int i = 0; i < 7; i++) {
+    pattern += recorder.sample() ? '1' : '0';
+  }
+  REQUIRE(pattern == "0010010");
+}
+
+TEST_CASE("Spans are written as Chrome trace complete events", "[trace]") {
+  pc_club::trace_recorder recorder;
+  {
+    pc_club::trace_span outer(&recorder, "outer");
+    pc_club::trace_span inner(&recorder, "inner");
+  }
+  {
+    pc_club::trace_span disabled(nullptr, "disabled");
+  }
+  REQUIRE(recorder.size() == 2);
+
+  auto path = std::filesystem::temp_directory_path() / "pc_club_trace_test.json";
+  REQUIRE(recorder.write(path.string()));
+
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::filesystem::remove(path);
+  auto json = ss.str();
+
+  REQUIRE(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  REQUIRE(json.find(R"("name":"inner","ph":"X")") < json.find(R"("name":"outer","ph":"X")"));
+  REQUIRE(json.find("disabled") == std::string::npos);
+}